@@ -1,29 +1,113 @@
 #pragma once
 #include <vector>
-#include <map>
+#include <string_view>
+#include <unordered_map>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
 #include <rip/binary/stream.h>
 #include <rip/binary/types.h>
 #include <rip/util/byteswap.h>
 
 namespace rip::binary::containers::binary_file {
-	template<typename AddressType>
-	class data_istream : public binary_istream<AddressType> {
-	protected:
-		binary_istream<AddressType>& stream;
-		std::map<size_t, std::string> strings{};
+	/*
+	 * BINA offset tables store the distance between consecutive offsets divided by 4, in 1, 2 or 4 big endian bytes.
+	 * The top 2 bits of the first byte give the size of the entry, and a 0 there ends the table.
+	 */
+
+	// Encodes a sorted list of offsets into a packed offset table, in one pass.
+	inline void encodeOffsetTable(const std::vector<size_t>& offsets, std::vector<unsigned char>& table) {
+		table.clear();
+		table.reserve(offsets.size());
 
-		void readStringTable(size_t tableSize) {
-			auto startPos = this->tellg();
-			auto pos = startPos;
-			std::string str{};
+		size_t last_offset = 0;
+
+		for (size_t offset : offsets) {
+			size_t diff = offset - last_offset;
+
+			if (diff >= (1 << 16)) {
+				unsigned int value = static_cast<unsigned int>((diff >> 2u) | (3u << 30u));
+				table.insert(table.end(), { static_cast<unsigned char>(value >> 24), static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 8), static_cast<unsigned char>(value) });
+			}
+			else if (diff >= (1 << 8)) {
+				unsigned short value = static_cast<unsigned short>((diff >> 2u) | (2u << 14u));
+				table.insert(table.end(), { static_cast<unsigned char>(value >> 8), static_cast<unsigned char>(value) });
+			}
+			else
+				table.push_back(static_cast<unsigned char>((diff >> 2u) | (1u << 6u)));
 
-			while (pos < startPos + tableSize) {
-				this->read_string(str);
-				strings[pos] = std::move(str);
-				pos = this->tellg();
+			last_offset = offset;
+		}
+	}
+
+	namespace internal {
+		// In-place inclusive prefix sum.
+		inline void prefixSum(std::vector<unsigned int>& values) {
+			size_t i = 0;
+			unsigned int carry = 0;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+			__m128i vcarry = _mm_setzero_si128();
+
+			for (; i + 4 <= values.size(); i += 4) {
+				__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&values[i]));
+				x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+				x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+				x = _mm_add_epi32(x, vcarry);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&values[i]), x);
+				vcarry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+			}
+
+			carry = static_cast<unsigned int>(_mm_cvtsi128_si32(vcarry));
+#endif
+
+			for (; i < values.size(); i++) {
+				carry += values[i];
+				values[i] = carry;
+			}
+		}
+	}
+
+	// Decodes a packed offset table into absolute offsets relative to the start of the data.
+	inline void decodeOffsetTable(const unsigned char* table, size_t tableSize, std::vector<unsigned int>& offsets) {
+		offsets.clear();
+		offsets.reserve(tableSize);
+
+		const unsigned char* end = table + tableSize;
+
+		while (table != end && (*table & 0xC0) != 0) {
+			switch (*table >> 6) {
+			case 1:
+				offsets.push_back((table[0] & 0x3Fu) << 2);
+				table += 1;
+				break;
+			case 2:
+				if (end - table < 2)
+					table = end;
+				else {
+					offsets.push_back((((table[0] & 0x3Fu) << 8) | table[1]) << 2);
+					table += 2;
+				}
+				break;
+			case 3:
+				if (end - table < 4)
+					table = end;
+				else {
+					offsets.push_back((((table[0] & 0x3Fu) << 24) | (table[1] << 16) | (table[2] << 8) | table[3]) << 2);
+					table += 4;
+				}
+				break;
 			}
 		}
 
+		internal::prefixSum(offsets);
+	}
+
+	template<typename AddressType>
+	class data_istream : public binary_istream<AddressType> {
+	protected:
+		binary_istream<AddressType>& stream;
+
 	public:
 		static constexpr bool hasNativeStrings = true;
 
@@ -37,62 +121,46 @@ namespace rip::binary::containers::binary_file {
 			AddressType stroff;
 			binary_istream<AddressType>::read(stroff);
 
-			if (stroff == 0)
-				obj = nullptr;
-			else if (strings.contains(stroff))
-				obj = strings[static_cast<size_t>(stroff)].c_str();
-			else {
-				auto pos = this->tellg();
-				this->seekg(stroff);
-				std::string str{};
-				this->read_string(str);
-				strings[static_cast<size_t>(stroff)] = std::move(str);
-				this->seekg(pos);
-			}
+			// Points straight into the input buffer, which outlives the stream.
+			obj = stroff == 0 ? nullptr : this->view_string(static_cast<size_t>(stroff)).data();
 		}
 	};
 
 	template<typename AddressType, std::endian endianness>
 	class data_ostream : public binary_ostream<AddressType, endianness> {
 	protected:
+		struct StringFixup {
+			size_t offset;
+			unsigned int stringIndex;
+		};
+
 		binary_ostream<AddressType, endianness>& stream;
-		std::vector<std::string> strings{}; // This seems superfluous but it is here to keep the discovery order, to generate a file that is closer to official files.
-		std::map<std::string, std::vector<size_t>> stringOffsets{};
+		// The views point into the data being serialized, which outlives the string table.
+		std::unordered_map<std::string_view, unsigned int> stringIndices{};
+		std::vector<std::string_view> strings{}; // Kept in discovery order, to generate a file that is closer to official files.
+		std::vector<StringFixup> stringFixups{};
 		std::vector<size_t> offsets{};
 
 		void writeStringTable() {
-			for (auto& string : strings) {
-				auto offsets = stringOffsets[string];
-				auto pos = this->tellp();
+			std::vector<size_t> stringPositions{};
+			stringPositions.reserve(strings.size());
 
-				for (auto offset : offsets) {
-					this->seekp(offset);
-					write(static_cast<AddressType>(pos));
-				}
-
-				this->seekp(pos);
-				this->write_string(string.c_str());
+			for (auto string : strings) {
+				stringPositions.push_back(this->tellp());
+				this->write_string(string.data());
 			}
 
+			for (auto& fixup : stringFixups)
+				this->write_at(fixup.offset, static_cast<AddressType>(stringPositions[fixup.stringIndex]));
+
 			this->write_padding(4);
 		}
 
 		void writeOffsetTable() {
-			size_t last_offset = 0;
-
-			for (size_t offset : offsets) {
-				size_t diff = offset - last_offset;
-
-				if (diff >= (1 << 16))
-					stream.write<unsigned int, false>(util::byteswap_to_native(std::endian::big, static_cast<unsigned int>((diff >> 2u) | (3u << 30u))));
-				else if (diff >= (1 << 8))
-					stream.write<unsigned short, false>(util::byteswap_to_native(std::endian::big, static_cast<unsigned short>((diff >> 2u) | (2u << 14u))));
-				else
-					stream.write<unsigned char, false>(static_cast<unsigned char>((diff >> 2u) | (1u << 6u)));
-
-				last_offset = offset;
-			}
+			std::vector<unsigned char> table{};
+			encodeOffsetTable(offsets, table);
 
+			stream.write_bytes(table.data(), table.size());
 			stream.write_padding(4);
 		}
 
@@ -115,15 +183,12 @@ namespace rip::binary::containers::binary_file {
 
 		template<> void write(const char* const& obj) {
 			if (obj != nullptr) {
-				auto i = stringOffsets.find(obj);
+				auto [it, inserted] = stringIndices.try_emplace(obj, static_cast<unsigned int>(strings.size()));
 
-				if (i == stringOffsets.end()) {
-					strings.emplace_back(obj);
-					stringOffsets[obj] = { this->tellp() };
-				}
-				else
-					i->second.emplace_back(this->tellp());
+				if (inserted)
+					strings.push_back(it->first);
 
+				stringFixups.push_back(StringFixup{ this->tellp(), it->second });
 				offsets.emplace_back(this->tellp());
 			}
 
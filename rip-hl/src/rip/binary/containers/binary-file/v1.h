@@ -90,14 +90,22 @@ namespace rip::binary::containers::binary_file::v1 {
 		binary_istream<AddrType> stream;
 		FileHeader header;
 
-	public:
-		BinaryFileReader(std::istream& stream_) : raw_stream{ stream_ }, stream{ raw_stream } {
+		void readHeader() {
 			stream.read(header);
 			stream.seekg(0);
 			stream.endianness = header.endianness == 'B' ? std::endian::big : std::endian::little;
 			stream.read(header);
 		}
 
+	public:
+		BinaryFileReader(std::istream& stream_) : raw_stream{ stream_ }, stream{ raw_stream } {
+			readHeader();
+		}
+
+		BinaryFileReader(const void* data, size_t size) : raw_stream{ data, size }, stream{ raw_stream } {
+			readHeader();
+		}
+
 		data_istream<AddrType> getData() {
 			return { raw_stream, stream, header.endianness == 'B' ? std::endian::big : std::endian::little, 0 };
 		}
@@ -132,6 +140,7 @@ namespace rip::binary::containers::binary_file::v1 {
 
 	public:
 		BinaryFileDeserializer(std::istream& stream) : container{ stream } {}
+		BinaryFileDeserializer(const void* data, size_t size) : container{ data, size } {}
 
 		template<typename GameInterface, typename T, typename R>
 		T* deserialize(R refl) {
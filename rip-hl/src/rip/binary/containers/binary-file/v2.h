@@ -1,10 +1,12 @@
 #pragma once
 #include <bit>
+#include <cstring>
 #include <map>
 #include <ucsl/magic.h>
 #include <ucsl-reflection/providers/simplerfl.h>
 #include <rip/binary/stream.h>
 #include <rip/util/byteswap.h>
+#include <rip/util/parallel.h>
 #include <rip/binary/serialization/ReflectionDeserializer.h>
 #include <rip/binary/serialization/ReflectionSerializer.h>
 #include <iostream>
@@ -90,9 +92,7 @@ namespace rip::binary::containers::binary_file::v2 {
 			chunkHeader.offsetTableSize = static_cast<unsigned int>(chunkEnd - offsetTableStart);
 			chunkHeader.additionalHeaderSize = additionalHeaderSize;
 
-			this->stream.seekp(chunkOffset);
-			this->stream.write(chunkHeader);
-			this->stream.seekp(chunkEnd);
+			this->stream.write_at(chunkOffset, chunkHeader);
 		}
 	};
 
@@ -103,14 +103,22 @@ namespace rip::binary::containers::binary_file::v2 {
 		FileHeader header;
 		std::endian endianness;
 
-	public:
-		BinaryFileReader(std::istream& stream_) : raw_stream{ stream_ }, stream{ raw_stream } {
+		void readHeader() {
 			stream.read(header);
 			stream.seekg(0);
 			stream.endianness = header.endianness == 'B' ? std::endian::big : std::endian::little;
 			stream.read(header);
 		}
 
+	public:
+		BinaryFileReader(std::istream& stream_) : raw_stream{ stream_ }, stream{ raw_stream } {
+			readHeader();
+		}
+
+		BinaryFileReader(const void* data, size_t size) : raw_stream{ data, size }, stream{ raw_stream } {
+			readHeader();
+		}
+
 		chunk_istream<AddrType> getNextDataChunk() {
 			return { raw_stream, stream, header.endianness == 'B' ? std::endian::big : std::endian::little };
 		}
@@ -146,9 +154,7 @@ namespace rip::binary::containers::binary_file::v2 {
 			fileHeader.fileSize = static_cast<unsigned int>(pos);
 			fileHeader.chunkCount = chunkCount;
 
-			stream.seekp(0);
-			stream.write(fileHeader);
-			stream.seekp(pos);
+			stream.write_at(0, fileHeader);
 		}
 	};
 
@@ -173,31 +179,89 @@ namespace rip::binary::containers::binary_file::v2 {
 			forEachChunk([](ChunkHeader* chunk) { util::byteswap_deep(*chunk); });
 		}
 
+		void resolveChunkAddresses(ChunkHeader* chunk) {
+			void* dataStart = addptr(chunk, sizeof(ChunkHeader) + chunk->additionalHeaderSize);
+			auto* offsetTable = static_cast<const unsigned char*>(addptr(dataStart, chunk->dataSize + chunk->stringTableSize));
+			std::endian endianness = file->endianness == 'B' ? std::endian::big : std::endian::little;
+
+			std::vector<unsigned int> offsets{};
+			decodeOffsetTable(offsetTable, chunk->offsetTableSize, offsets);
+
+			for (unsigned int offsetLoc : offsets) {
+				size_t* offset = static_cast<size_t*>(addptr(dataStart, offsetLoc));
+
+				util::byteswap_deep_to_native(endianness, *offset);
+
+				if (*offset != 0)
+					*offset += reinterpret_cast<size_t>(dataStart);
+			}
+		}
+
+		// Chunks have their own offset tables, so they can be resolved independently.
 		void resolveAddresses() {
-			forEachChunk([=](ChunkHeader* chunk) {
-				void* dataStart = addptr(chunk, sizeof(ChunkHeader) + chunk->additionalHeaderSize);
-				void* offsetLoc = dataStart;
-				void* offsetsStart = addptr(chunk, sizeof(ChunkHeader) + chunk->additionalHeaderSize + chunk->dataSize + chunk->stringTableSize);
-				void* offsets = offsetsStart;
+			std::vector<ChunkHeader*> chunks{};
+
+			forEachChunk([&](ChunkHeader* chunk) { chunks.push_back(chunk); });
+
+			util::parallel_for(chunks.size(), [&](size_t i) { resolveChunkAddresses(chunks[i]); });
+		}
 
-				while (offsets != addptr(offsetsStart, chunk->offsetTableSize) && (*static_cast<unsigned char*>(offsets) & 0xC0) != 0) {
-					switch ((*static_cast<unsigned char*>(offsets) & 0xC0) >> 6) {
-					case 1: offsetLoc = addptr(offsetLoc, (*static_cast<unsigned char*>(offsets) & 0x3F) << 2); offsets = addptr(offsets, 1); break;
-					case 2: offsetLoc = addptr(offsetLoc, (util::byteswap_to_native(std::endian::big, *static_cast<unsigned short*>(offsets)) & 0x3FFF) << 2); offsets = addptr(offsets, 2); break;
-					case 3: offsetLoc = addptr(offsetLoc, (util::byteswap_to_native(std::endian::big, *static_cast<unsigned int*>(offsets)) & 0x3FFFFFFF) << 2); offsets = addptr(offsets, 4); break;
-					}
+	public:
+		/*
+		 * Checks that a file in native byte order can be resolved without reading or writing out of bounds: all chunks
+		 * are DATA chunks that lie within the file together with their tables, every offset in the offset tables is
+		 * located inside the data of its chunk, and every non-null offset points inside the data or string table of
+		 * its chunk (or right at its end, where dangling pointers of empty arrays end up).
+		 */
+		static bool validate(const void* data, size_t size) {
+			if (size < sizeof(FileHeader))
+				return false;
+
+			auto* header = static_cast<const FileHeader*>(data);
+
+			if (header->fileSize < sizeof(FileHeader) || header->fileSize > size)
+				return false;
+
+			size_t offset{ sizeof(FileHeader) };
+			std::vector<unsigned int> offsets{};
+
+			for (unsigned int i = 0; i < header->chunkCount; i++) {
+				if (header->fileSize - offset < sizeof(ChunkHeader))
+					return false;
+
+				auto* chunk = static_cast<const ChunkHeader*>(addptr(data, offset));
+
+				if (!(chunk->magic == "DATA") || chunk->size < sizeof(ChunkHeader) || chunk->size > header->fileSize - offset)
+					return false;
+
+				size_t tablesEnd = sizeof(ChunkHeader) + size_t{ chunk->additionalHeaderSize } + chunk->dataSize + chunk->stringTableSize + chunk->offsetTableSize;
 
-					size_t* offset = static_cast<size_t*>(offsetLoc);
+				if (tablesEnd > chunk->size)
+					return false;
 
-					util::byteswap_deep_to_native(file->endianness == 'B' ? std::endian::big : std::endian::little, *offset);
+				auto* offsetTable = static_cast<const unsigned char*>(addptr(data, offset + tablesEnd - chunk->offsetTableSize));
 
-					if (*offset != 0)
-						*offset += reinterpret_cast<size_t>(dataStart);
+				decodeOffsetTable(offsetTable, chunk->offsetTableSize, offsets);
+
+				size_t dataStart = offset + sizeof(ChunkHeader) + chunk->additionalHeaderSize;
+
+				for (unsigned int offsetLoc : offsets) {
+					if (size_t{ offsetLoc } + sizeof(size_t) > chunk->dataSize)
+						return false;
+
+					size_t target;
+					memcpy(&target, addptr(data, dataStart + offsetLoc), sizeof(target));
+
+					if (target > size_t{ chunk->dataSize } + chunk->stringTableSize)
+						return false;
 				}
-			});
+
+				offset += chunk->size;
+			}
+
+			return true;
 		}
 
-	public:
 		inline BinaryFileResolver(void* file_) : file{ static_cast<FileHeader*>(file_) } {
 			if (file->flags & 1)
 				return;
@@ -228,6 +292,7 @@ namespace rip::binary::containers::binary_file::v2 {
 
 	public:
 		BinaryFileDeserializer(std::istream& stream) : container{ stream } {}
+		BinaryFileDeserializer(const void* data, size_t size) : container{ data, size } {}
 
 		template<typename GameInterface, typename T, typename R>
 		T* deserialize(R refl) {
@@ -247,15 +312,16 @@ namespace rip::binary::containers::binary_file::v2 {
 	template<typename AddrType, std::endian endianness = std::endian::native>
 	class BinaryFileSerializer {
 		BinaryFileWriter<AddrType, endianness> container;
+		SerializerOptions options;
 
 	public:
-		BinaryFileSerializer(std::ostream& stream) : container{ stream } {}
+		BinaryFileSerializer(std::ostream& stream, SerializerOptions options = {}) : container{ stream }, options{ options } {}
 
 		template<typename T, typename R>
 		void serialize(T& data, R refl) {
 			auto chunk = container.addDataChunk();
 
-			rip::binary::ReflectionSerializer serializer{ chunk };
+			rip::binary::ReflectionSerializer serializer{ chunk, options };
 
 			serializer.serialize(data, refl);
 		}
@@ -44,6 +44,11 @@ namespace rip::binary::containers::mirage::v1 {
         binary_istream<AddressType> stream;
         FileHeader header;
 
+        void readHeader() {
+            stream.read(header);
+            stream.skip_padding_bytes(header.headerSize - sizeof(FileHeader));
+        }
+
     public:
         class data_istream : public binary_istream<AddressType> {
         public:
@@ -51,8 +56,11 @@ namespace rip::binary::containers::mirage::v1 {
         };
 
         MirageResourceImageReader(std::istream& stream_) : raw_stream{ stream_ }, stream{ raw_stream, std::endian::big } {
-            stream.read(header);
-            stream.skip_padding_bytes(header.headerSize - sizeof(FileHeader));
+            readHeader();
+        }
+
+        MirageResourceImageReader(const void* data, size_t size) : raw_stream{ data, size }, stream{ raw_stream, std::endian::big } {
+            readHeader();
         }
 
         data_istream get_data() {
@@ -124,9 +132,7 @@ namespace rip::binary::containers::mirage::v1 {
             fileHeader.headerSize = 0x18;
             fileHeader.offsetTableOffset = offsetTableOffset;
 
-            stream.seekp(0);
-            stream.write(fileHeader);
-            stream.seekp(pos);
+            stream.write_at(0, fileHeader);
         }
 
         void writeAddressResolutionChunk() {
@@ -93,6 +93,10 @@ namespace rip::binary::containers::mirage::v2 {
             stream.read(header);
         }
 
+        MirageResourceImageReader(const void* data, size_t size) : raw_stream{ data, size }, stream{ raw_stream } {
+            stream.read(header);
+        }
+
         node_istream get_root_node() {
             return { raw_stream, endianness };
         }
@@ -147,9 +151,7 @@ namespace rip::binary::containers::mirage::v2 {
                 nodeHeader.version = version;
                 nodeHeader.magic = magic;
 
-                this->seekp(nodeOffset);
-                this->write(nodeHeader);
-                this->seekp(nodeEnd);
+                this->write_at(nodeOffset, nodeHeader);
 
                 this->write_padding(16);
             }
@@ -205,9 +207,7 @@ namespace rip::binary::containers::mirage::v2 {
             fileHeader.offsetCount = addressLocations.size();
             fileHeader.offsetTableOffset = offsetTableOffset;
 
-            stream.seekp(0);
-            stream.write(fileHeader);
-            stream.seekp(pos);
+            stream.write_at(0, fileHeader);
         }
 
         void writeAddressResolutionChunk() {
@@ -7,10 +7,10 @@ namespace rip::binary::containers::swif::v1 {
 	{
 	}
 
-	SWIFSerializer::SWIFSerializer(std::ostream& stream) : rawStream{ stream } {
+	SWIFSerializer::SWIFSerializer(std::ostream& stream, SerializerOptions options) : rawStream{ stream }, reflectionSerializer{ this->stream, options } {
 		writeBinaryFileHeaderChunk();
 
-		chunksStart = stream.tellp();
+		chunksStart = this->stream.tellp();
 	}
 
 	SWIFSerializer::~SWIFSerializer() {
@@ -26,8 +26,7 @@ namespace rip::binary::containers::swif::v1 {
 		header.addressResolutionHeaderOffset = static_cast<unsigned int>(addressResolutionChunkOffset);
 		header.revision = 20120705;
 
-		stream.seekp(8);
-		stream.write(header);
+		stream.write_at(8, header);
 	}
 
 	void SWIFSerializer::writeBinaryFileHeaderChunk() {
@@ -108,7 +108,7 @@ namespace rip::binary::containers::swif::v1 {
 
 		fast_ostream rawStream;
 		swif_ostream stream{ *this };
-		ReflectionSerializer<swif_ostream> reflectionSerializer{ stream };
+		ReflectionSerializer<swif_ostream> reflectionSerializer;
 		std::vector<unsigned int> addressLocations{};
 		size_t addressResolutionChunkOffset{};
 		size_t chunksStart{};
@@ -132,9 +132,7 @@ namespace rip::binary::containers::swif::v1 {
 			size_t end = stream.tellp();
 			chunkHeader.chunkSize = static_cast<unsigned int>(end - dataStart);
 
-			stream.seekp(start);
-			stream.write(chunkHeader);
-			stream.seekp(end);
+			stream.write_at(start, chunkHeader);
 		}
 
 		template<typename F>
@@ -176,7 +174,7 @@ namespace rip::binary::containers::swif::v1 {
 		void writeAddressResolutionChunk();
 		void writeEndChunk();
 	public:
-		SWIFSerializer(std::ostream& stream);
+		SWIFSerializer(std::ostream& stream, SerializerOptions options = {});
 		~SWIFSerializer();
 
 		template<typename GameInterface, typename P>
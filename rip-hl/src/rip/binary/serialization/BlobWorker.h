@@ -2,9 +2,13 @@
 
 #include <map>
 #include <queue>
+#include <vector>
+#include <algorithm>
 #include <functional>
 #include <cassert>
+#include <cstring>
 #include <rip/util/memory.h>
+#include "TaskQueue.h"
 
 namespace rip::binary {
 	struct BlockAllocationData {
@@ -58,6 +62,124 @@ namespace rip::binary {
 		}
 	};
 
+	/*
+	 * Hands out zeroed memory from large chunks while keeping track of where each block would end up if all blocks
+	 * were laid out sequentially in a single buffer. This allows a single pass to both discover the size of the data
+	 * and write it: once the traversal is done, commit() copies all blocks into one allocation and relocate() translates
+	 * pointers that were stored in the arena.
+	 */
+	template<typename GameInterface, typename T = void>
+	class ArenaBlockAllocator {
+		struct Block {
+			T* ptr;
+			size_t offset;
+			size_t size;
+			size_t arenaSize; // zero-sized blocks still take up a byte in the arena so they have a unique address.
+		};
+
+		static constexpr size_t chunkSize = 1024 * 1024;
+
+		std::vector<void*> chunks{};
+		std::vector<Block> blocks{};
+		SequentialBlockAllocator seqAllocator{};
+		size_t chunkPos{};
+		size_t chunkEnd{};
+
+		void* allocateArenaMemory(size_t size, size_t alignment) {
+			size_t pos = align(chunkPos, alignment);
+
+			if (chunks.empty() || pos + size > chunkEnd) {
+				size_t newChunkSize = std::max(chunkSize, size + alignment);
+				void* chunk = GameInterface::AllocatorSystem::get_allocator()->Alloc(newChunkSize, 16);
+
+				memset(chunk, 0, newChunkSize);
+				chunks.push_back(chunk);
+
+				chunkPos = reinterpret_cast<size_t>(chunk);
+				chunkEnd = chunkPos + newChunkSize;
+				pos = align(chunkPos, alignment);
+			}
+
+			chunkPos = pos + size;
+			return reinterpret_cast<void*>(pos);
+		}
+
+		const Block* findBlock(const void* addr) const {
+			auto it = std::upper_bound(blocks.begin(), blocks.end(), addr, [](const void* a, const Block& block) { return a < static_cast<const void*>(block.ptr); });
+
+			if (it == blocks.begin())
+				return nullptr;
+
+			--it;
+
+			return reinterpret_cast<size_t>(addr) - reinterpret_cast<size_t>(it->ptr) < it->arenaSize ? &*it : nullptr;
+		}
+
+		template<typename U>
+		U* translate(const Block& block, U* addr) const {
+			return reinterpret_cast<U*>(reinterpret_cast<size_t>(origin) + block.offset + (reinterpret_cast<size_t>(addr) - reinterpret_cast<size_t>(block.ptr)));
+		}
+
+	public:
+		T* origin{};
+
+		ArenaBlockAllocator() = default;
+		ArenaBlockAllocator(const ArenaBlockAllocator&) = delete;
+
+		~ArenaBlockAllocator() {
+			release();
+		}
+
+		T* allocate(BlockAllocationData allocationData) {
+			size_t offset = seqAllocator.allocate(allocationData);
+			size_t arenaSize = std::max(allocationData.size, static_cast<size_t>(1));
+			T* ptr = static_cast<T*>(allocateArenaMemory(arenaSize, allocationData.alignment));
+
+			blocks.push_back({ ptr, offset, allocationData.size, arenaSize });
+			return ptr;
+		}
+
+		// Copies all blocks into a single allocation of the size a sequential layout of the blocks requires.
+		T* commit() {
+			size_t size = seqAllocator.nextOffset;
+
+			origin = static_cast<T*>(GameInterface::AllocatorSystem::get_allocator()->Alloc(size, 16));
+			memset(origin, 0, size);
+
+			for (auto& block : blocks)
+				memcpy(addptr(origin, block.offset), block.ptr, block.size);
+
+			std::sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) { return a.ptr < b.ptr; });
+
+			return origin;
+		}
+
+		// Given a pointer slot in the arena, updates the matching slot in the committed buffer so it points into the committed buffer.
+		// Slots outside of the arena (e.g. on the stack) are ignored.
+		void relocate(T** slot) const {
+			const Block* slotBlock = findBlock(slot);
+
+			if (slotBlock == nullptr)
+				return;
+
+			T* value = *slot;
+			const Block* valueBlock = value == nullptr ? nullptr : findBlock(value);
+
+			*translate(*slotBlock, slot) = valueBlock == nullptr ? value : translate(*valueBlock, value);
+		}
+
+		// Frees the arena. The committed buffer is not affected.
+		void release() {
+			for (void* chunk : chunks)
+				GameInterface::AllocatorSystem::get_allocator()->Free(chunk);
+
+			chunks.clear();
+			blocks.clear();
+			chunkPos = 0;
+			chunkEnd = 0;
+		}
+	};
+
 	enum class SchedulingType {
 		IMMEDIATE,
 		DEFERRED,
@@ -154,6 +276,59 @@ namespace rip::binary {
 		}
 	};
 
+	// Same as DeferredBlobWorkerScheduler, but the queued work lives in a TaskQueue instead of std::functions.
+	template<typename T, typename Allocator>
+	class ArenaDeferredBlobWorkerScheduler {
+		TaskQueue workQueue{};
+		Allocator& allocator;
+
+	public:
+		ArenaDeferredBlobWorkerScheduler(Allocator& allocator) : allocator{ allocator } {}
+
+		void enqueueBlock(auto guard, auto storeOffset, auto allocationDataGetter, auto processFunc) {
+			if (!guard())
+				return;
+
+			auto allocationData = allocationDataGetter();
+			T offset = allocator.allocate(allocationData);
+			storeOffset(offset);
+			workQueue.push([offset, alignment = allocationData.alignment, processFunc]() mutable {
+				processFunc(offset, alignment);
+			});
+		}
+
+		void processQueuedBlocks() {
+			workQueue.run();
+		}
+	};
+
+	// Same as DeferredAllocationBlobWorkerScheduler, but the queued work lives in a TaskQueue instead of std::functions.
+	template<typename T, typename Allocator>
+	class ArenaDeferredAllocationBlobWorkerScheduler {
+		TaskQueue workQueue{};
+		Allocator& allocator;
+
+	public:
+		ArenaDeferredAllocationBlobWorkerScheduler(Allocator& allocator) : allocator{ allocator } {}
+
+		void enqueueBlock(auto guard, auto storeOffset, auto allocationDataGetter, auto processFunc) {
+			workQueue.push([this, guard, storeOffset, allocationDataGetter, processFunc]() mutable {
+				if (!guard())
+					return;
+
+				storeOffset((T)0xFAFAFAFA);
+				BlockAllocationData allocationData = allocationDataGetter();
+				T offset = allocator.allocate(allocationData);
+				storeOffset(offset);
+				processFunc(offset, allocationData.alignment);
+			});
+		}
+
+		void processQueuedBlocks() {
+			workQueue.run();
+		}
+	};
+
 	template<typename T = size_t, typename Allocator = SequentialBlockAllocator, template<typename, typename> typename Scheduler = DeferredBlobWorkerScheduler>
 	class BlobWorker {
 	public:
@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rip::binary {
+	/*
+	 * Index to name and name to index tables for the options of an enum.
+	 * When an index or name occurs more than once, the first option wins, as with a linear scan.
+	 */
+	class EnumLookup {
+		// Indices are looked up in a dense table when they are close together, and by binary search otherwise.
+		long long minIndex{};
+		std::vector<const char*> denseNames{};
+		std::vector<std::pair<long long, const char*>> sparseNames{};
+		std::unordered_map<std::string_view, long long> indices{};
+
+	public:
+		EnumLookup() = default;
+
+		template<typename Options>
+		EnumLookup(const Options& options) {
+			if (std::begin(options) == std::end(options))
+				return;
+
+			long long maxIndex{};
+			size_t count{};
+
+			minIndex = static_cast<long long>(std::begin(options)->GetIndex());
+			maxIndex = minIndex;
+
+			for (auto& option : options) {
+				long long index = static_cast<long long>(option.GetIndex());
+
+				minIndex = std::min(minIndex, index);
+				maxIndex = std::max(maxIndex, index);
+				count++;
+
+				indices.try_emplace(option.GetEnglishName(), index);
+			}
+
+			if (static_cast<unsigned long long>(maxIndex - minIndex) <= count * 4 + 16) {
+				denseNames.resize(static_cast<size_t>(maxIndex - minIndex) + 1);
+
+				for (auto& option : options) {
+					auto& name = denseNames[static_cast<size_t>(static_cast<long long>(option.GetIndex()) - minIndex)];
+
+					if (name == nullptr)
+						name = option.GetEnglishName();
+				}
+			}
+			else {
+				for (auto& option : options)
+					sparseNames.emplace_back(static_cast<long long>(option.GetIndex()), option.GetEnglishName());
+
+				std::stable_sort(sparseNames.begin(), sparseNames.end(), [](auto& a, auto& b) { return a.first < b.first; });
+			}
+		}
+
+		// Returns nullptr if no option has this index.
+		const char* getName(long long index) const {
+			if (!denseNames.empty())
+				return index < minIndex || index - minIndex >= static_cast<long long>(denseNames.size()) ? nullptr : denseNames[static_cast<size_t>(index - minIndex)];
+
+			auto it = std::lower_bound(sparseNames.begin(), sparseNames.end(), index, [](auto& entry, long long index) { return entry.first < index; });
+
+			return it == sparseNames.end() || it->first != index ? nullptr : it->second;
+		}
+
+		std::optional<long long> getIndex(std::string_view name) const {
+			auto it = indices.find(name);
+
+			return it == indices.end() ? std::nullopt : std::make_optional(it->second);
+		}
+	};
+
+	/*
+	 * Returns the lookup tables for a set of enum options, building them the first time they are requested.
+	 * Tables are cached per thread by the address of the options, and checked against the first and last option
+	 * so that a different set of options reusing the same memory is not mistaken for a cached one.
+	 */
+	template<typename Options>
+	const EnumLookup& getEnumLookup(const Options& options) {
+		struct CacheEntry {
+			size_t count;
+			const char* firstName;
+			const char* lastName;
+			std::unique_ptr<EnumLookup> lookup;
+		};
+
+		static const EnumLookup empty{};
+		thread_local std::unordered_map<const void*, CacheEntry> cache{};
+
+		auto begin = std::begin(options);
+		auto end = std::end(options);
+
+		if (begin == end)
+			return empty;
+
+		size_t count = static_cast<size_t>(std::distance(begin, end));
+		const char* firstName = begin->GetEnglishName();
+		const char* lastName = std::next(begin, count - 1)->GetEnglishName();
+
+		auto& entry = cache[&*begin];
+
+		if (!entry.lookup || entry.count != count || entry.firstName != firstName || entry.lastName != lastName)
+			entry = { count, firstName, lastName, std::make_unique<EnumLookup>(options) };
+
+		return *entry.lookup;
+	}
+}
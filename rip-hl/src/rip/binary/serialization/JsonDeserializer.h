@@ -3,10 +3,15 @@
 #include <ucsl-reflection/traversals/types.h>
 #include <ucsl-reflection/opaque.h>
 #include <rip/util/object-id-guids.h>
+#include <rip/util/mapped-file.h>
 #include <yyjson.h>
 #include <iomanip>
 #include <sstream>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
 #include "BlobWorker.h"
+#include "EnumLookup.h"
 
 namespace rip::binary {
 	using namespace ucsl::reflection;
@@ -15,9 +20,58 @@ namespace rip::binary {
 	template<typename GameInterface, bool arrayVectors = false>
 	class JsonDeserializer {
 		yyjson_doc* doc{};
-		const char* filename;
+		yyjson_val* root{};
+		const char* filename{};
 		opaque_obj* result{};
 
+		// The document is parsed in situ in a private mapping of the file, with its values in a pool that is kept
+		// around for later documents.
+		util::mapped_file file{};
+		std::unique_ptr<char[]> pool{};
+		size_t poolSize{};
+		yyjson_alc alc{};
+
+		/*
+		 * Looks up the fields of a struct in its JSON object. Fields are expected in reflection order, as written by
+		 * JsonSerializer, so each lookup first checks the key after the previous match. Keys that are out of order
+		 * or missing are looked up in a hash table that is built the first time it is needed.
+		 */
+		class FieldCursor {
+			yyjson_val* object;
+			yyjson_obj_iter iter;
+			yyjson_val* nextKey;
+			std::unique_ptr<std::unordered_map<std::string_view, yyjson_val*>> index{};
+
+		public:
+			FieldCursor(yyjson_val* object) : object{ object }, iter{ yyjson_obj_iter_with(object) }, nextKey{ yyjson_obj_iter_next(&iter) } {}
+
+			bool is_for(yyjson_val* val) const {
+				return val == object;
+			}
+
+			yyjson_val* get(const char* name) {
+				if (nextKey != nullptr && yyjson_equals_str(nextKey, name)) {
+					yyjson_val* val = yyjson_obj_iter_get_val(nextKey);
+					nextKey = yyjson_obj_iter_next(&iter);
+					return val;
+				}
+
+				if (!index) {
+					index = std::make_unique<std::unordered_map<std::string_view, yyjson_val*>>(yyjson_obj_size(object));
+
+					size_t i, max;
+					yyjson_val* key;
+					yyjson_val* val;
+					yyjson_obj_foreach(object, i, max, key, val) {
+						index->try_emplace(std::string_view{ yyjson_get_str(key), yyjson_get_len(key) }, val);
+					}
+				}
+
+				auto it = index->find(name);
+				return it == index->end() ? nullptr : it->second;
+			}
+		};
+
 		template<typename OpState>
 		class OperationBase {
 		public:
@@ -210,7 +264,7 @@ namespace rip::binary {
 				auto allocator = (void**)addptr(&obj, 0x8);
 				if (yyjson_is_null(state.currentVal))
 					*buffer = nullptr;
-				else if (!strcmp("", yyjson_get_str(state.currentVal)))
+				else if (yyjson_get_len(state.currentVal) == 0)
 					*buffer = nullptr;
 				else
 					visit_primitive(*buffer, PrimitiveInfo<const char*>{});
@@ -219,13 +273,15 @@ namespace rip::binary {
 			}
 
 			result_type visit_primitive(const char*& obj, const PrimitiveInfo<const char*>& info) {
-				if (yyjson_is_null(state.currentVal))
+				if (!yyjson_is_str(state.currentVal))
 					obj = nullptr;
 				else {
 					const char* str = yyjson_get_str(state.currentVal);
+					size_t length = yyjson_get_len(state.currentVal);
 
-					enqueue_block(obj, [size = strlen(str) + 1]() { return BlockAllocationData{ size, 1 }; }, [str](const char* target) {
-						strcpy_s(const_cast<char*>(target), strlen(str) + 1, str);
+					// The target is zeroed, so this also terminates the string.
+					enqueue_block(obj, [length]() { return BlockAllocationData{ length + 1, 1 }; }, [str, length](const char* target) {
+						memcpy(const_cast<char*>(target), str, length);
 						return 0;
 					});
 				}
@@ -238,12 +294,9 @@ namespace rip::binary {
 
 			template<typename T, typename O>
 			result_type visit_enum(T& obj, const EnumInfo<O>& info) {
-				const char* str = yyjson_get_str(state.currentVal);
-				for (auto& option : info.options) {
-					if (!strcmp(option.GetEnglishName(), str)) {
-						obj = static_cast<T>(option.GetIndex());
-						return 0;
-					}
+				if (auto index = getEnumLookup(info.options).getIndex({ yyjson_get_str(state.currentVal), yyjson_get_len(state.currentVal) })) {
+					obj = static_cast<T>(index.value());
+					return 0;
 				}
 				assert("unhandled enum");
 				return 0;
@@ -332,7 +385,9 @@ namespace rip::binary {
 
 			template<typename F>
 			result_type visit_field(opaque_obj& obj, const FieldInfo& info, F f) {
-				with_val(yyjson_obj_get(state.currentVal, info.name), [f, &obj]() { return f(obj); });
+				yyjson_val* val = state.currentStruct != nullptr && state.currentStruct->is_for(state.currentVal) ? state.currentStruct->get(info.name) : yyjson_obj_get(state.currentVal, info.name);
+
+				with_val(val, [f, &obj]() { return f(obj); });
 				return 0;
 			}
 
@@ -343,13 +398,21 @@ namespace rip::binary {
 
 			template<typename F>
 			result_type visit_struct(opaque_obj& obj, const StructureInfo& info, F f) {
-				return f(obj);
+				if (!yyjson_is_obj(state.currentVal))
+					return f(obj);
+
+				FieldCursor cursor{ state.currentVal };
+				FieldCursor* prevStruct = state.currentStruct;
+				state.currentStruct = &cursor;
+				result_type res = f(obj);
+				state.currentStruct = prevStruct;
+				return res;
 			}
 
 			template<typename F>
 			result_type visit_root(opaque_obj& obj, const RootInfo& info, F f) {
 				opaque_obj* ptr;
-				with_val(yyjson_doc_get_root(state.deserializer.doc), [f, this, &ptr, &info]() {
+				with_val(state.deserializer.root, [f, this, &ptr, &info]() {
 					enqueue_block(ptr, [info]() { return BlockAllocationData{ info.size, info.alignment }; }, [f](opaque_obj* target) {
 						f(*target);
 						return 0;
@@ -365,16 +428,17 @@ namespace rip::binary {
 		struct OperationState {
 			JsonDeserializer& deserializer;
 			yyjson_val* currentVal{};
-			BlobWorker<opaque_obj*, Allocator, DeferredAllocationBlobWorkerScheduler> worker{};
+			FieldCursor* currentStruct{};
+			BlobWorker<opaque_obj*, Allocator, ArenaDeferredAllocationBlobWorkerScheduler> worker{};
 		};
 
 		using MeasureState = OperationState<HeapBlockAllocator<GameInterface, opaque_obj>>;
 		using WriteState = OperationState<SequentialMemoryBlockAllocator<opaque_obj>>;
 
-		MeasureState measureState{ *this };
-		WriteState writeState{ *this };
-
 	public:
+		JsonDeserializer() {
+		}
+
 		JsonDeserializer(const char* filename) : filename{ filename } {
 		}
 
@@ -384,13 +448,36 @@ namespace rip::binary {
 
 		template<typename T, typename R>
 		T* deserialize(R refl) {
+			yyjson_doc_free(doc);
+			doc = nullptr;
+
+			file = util::mapped_file{ filename, YYJSON_PADDING_SIZE };
+
+			size_t requiredPoolSize = yyjson_read_max_memory_usage(file.size(), YYJSON_READ_INSITU);
+			if (requiredPoolSize > poolSize) {
+				pool = std::make_unique<char[]>(requiredPoolSize);
+				poolSize = requiredPoolSize;
+			}
+			yyjson_alc_pool_init(&alc, pool.get(), poolSize);
+
 			yyjson_read_err err;
-			doc = yyjson_read_file(filename, 0, nullptr, &err);
+			doc = yyjson_read_opts(static_cast<char*>(file.data()), file.size(), YYJSON_READ_INSITU, &alc, &err);
 			if (err.code != YYJSON_READ_SUCCESS) {
 				std::cout << "Error reading json: " << err.msg << std::endl;
 				return nullptr;
 			}
 
+			return deserialize<T>(yyjson_doc_get_root(doc), refl);
+		}
+
+		// Deserializes a value of an already parsed document into a single allocation, which the caller has to free.
+		template<typename T, typename R>
+		T* deserialize(yyjson_val* value, R refl) {
+			root = value;
+
+			MeasureState measureState{ *this };
+			WriteState writeState{ *this };
+
 			T* stub{};
 			ucsl::reflection::traversals::traversal<OperationBase<MeasureState>> measureOp{ measureState };
 			measureOp.operator()<T>(*stub, refl);
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <sstream>
 #include <rip/util/object-id-guids.h>
+#include "EnumLookup.h"
 
 namespace rip::binary {
 	using namespace ucsl::reflection;
@@ -203,12 +204,8 @@ namespace rip::binary {
 
 			template<typename T, typename O>
 			result_type visit_enum(T& obj, const EnumInfo<O>& info) {
-				yyjson_mut_val* val = visit_primitive(obj, PrimitiveInfo<T>{}).value;
-				auto v = yyjson_mut_get_sint(val);
-				for (auto& option : info.options)
-					if (option.GetIndex() == v)
-						return yyjson_mut_strcpy(serializer.doc, option.GetEnglishName());
-				return nullptr;
+				const char* name = getEnumLookup(info.options).getName(static_cast<long long>(obj));
+				return name == nullptr ? nullptr : yyjson_mut_strcpy(serializer.doc, name);
 			}
 
 			template<typename T, typename O>
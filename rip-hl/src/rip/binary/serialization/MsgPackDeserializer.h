@@ -0,0 +1,407 @@
+#pragma once
+#include <ucsl-reflection/reflections/basic-types.h>
+#include <ucsl-reflection/traversals/types.h>
+#include <ucsl-reflection/opaque.h>
+#include <rip/util/object-id-guids.h>
+#include <rip/util/mapped-file.h>
+#include <rip/util/msgpack-reader.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "BlobWorker.h"
+#include "EnumLookup.h"
+
+namespace rip::binary {
+	using namespace ucsl::reflection;
+	using namespace ucsl::reflection::traversals;
+
+	/*
+	 * Reads the MessagePack structure written by MsgPackSerializer.
+	 * Missing values are read as nil, which gives the same defaults as missing values in JSON input.
+	 */
+	template<typename GameInterface, bool arrayVectors = false>
+	class MsgPackDeserializer {
+		using value_type = util::msgpack_value;
+
+		inline static const value_type nilValue{};
+
+		const char* filename;
+		util::mapped_file file{};
+		util::msgpack_document doc{};
+		opaque_obj* result{};
+
+		static const value_type* get(const value_type* val, const char* key) {
+			const value_type* res = val->get(key);
+			return res == nullptr ? &nilValue : res;
+		}
+
+		// Same lookup strategy as JsonDeserializer: fields are expected in reflection order, with a hash table
+		// built on the first out of order or missing key.
+		class FieldCursor {
+			const value_type* object;
+			size_t next{};
+			std::unique_ptr<std::unordered_map<std::string_view, const value_type*>> index{};
+
+		public:
+			FieldCursor(const value_type* object) : object{ object } {}
+
+			bool is_for(const value_type* val) const {
+				return val == object;
+			}
+
+			const value_type* get(const char* name) {
+				if (next < object->size() && object->key_at(next)->is_str() && object->key_at(next)->get_view() == name)
+					return object->value_at(next++);
+
+				if (!index) {
+					index = std::make_unique<std::unordered_map<std::string_view, const value_type*>>(object->size());
+
+					for (size_t i = 0; i < object->size(); i++)
+						if (object->key_at(i)->is_str())
+							index->try_emplace(object->key_at(i)->get_view(), object->value_at(i));
+				}
+
+				auto it = index->find(name);
+				return it == index->end() ? &nilValue : it->second;
+			}
+		};
+
+		template<typename OpState>
+		class OperationBase {
+		public:
+			constexpr static size_t arity = 1;
+			using result_type = int;
+			OpState& state;
+
+			template<typename F>
+			result_type with_val(const value_type* val, F f) {
+				const value_type* prevVal = state.currentVal;
+				state.currentVal = val;
+				auto res = f();
+				state.currentVal = prevVal;
+				return res;
+			}
+
+			template<typename T>
+			void enqueue_block(T*& ptr, auto alignmentGetter, auto processFunc) {
+				state.worker.enqueueBlock((opaque_obj*&)ptr, alignmentGetter, [this, processFunc, blockVal = state.currentVal](opaque_obj* offset, size_t alignment) {
+					with_val(blockVal, [processFunc, offset]() { return processFunc((T*)offset); });
+				});
+			}
+
+			template<typename T>
+			void read_vector(T& obj, std::initializer_list<const char*> names) {
+				if constexpr (arrayVectors) {
+					assert(state.currentVal->size() == obj.rows() * obj.cols());
+					for (size_t i = 0; i < state.currentVal->size(); i++)
+						obj(i, 0) = static_cast<float>(state.currentVal->item(i)->get_num());
+				}
+				else {
+					size_t i = 0;
+
+					for (auto* name : names)
+						obj(i++, 0) = static_cast<float>(get(state.currentVal, name)->get_num());
+				}
+			}
+
+			template<typename T>
+			void read_matrix(T& obj) {
+				assert(state.currentVal->size() == obj.rows() * obj.cols());
+				for (size_t i = 0; i < state.currentVal->size(); i++)
+					obj(i / obj.cols(), i % obj.cols()) = static_cast<float>(state.currentVal->item(i)->get_num());
+			}
+
+			OperationBase(OpState& state) : state{ state } {}
+
+			template<std::integral T, std::enable_if_t<std::is_signed_v<T>, bool> = true>
+			result_type visit_primitive(T& obj, const PrimitiveInfo<T>& info) {
+				obj = static_cast<T>(info.erased ? 0ll : info.constantValue.has_value() ? info.constantValue.value() : state.currentVal->get_sint());
+				return 0;
+			}
+
+			template<std::integral T, std::enable_if_t<!std::is_signed_v<T>, bool> = true>
+			result_type visit_primitive(T& obj, const PrimitiveInfo<T>& info) {
+				obj = static_cast<T>(info.erased ? 0ull : info.constantValue.has_value() ? info.constantValue.value() : state.currentVal->get_uint());
+				return 0;
+			}
+
+			result_type visit_primitive(float& obj, const PrimitiveInfo<float>& info) {
+				obj = info.erased ? 0.0f : info.constantValue.has_value() ? info.constantValue.value() : static_cast<float>(state.currentVal->get_num());
+				return 0;
+			}
+
+			result_type visit_primitive(double& obj, const PrimitiveInfo<double>& info) {
+				obj = info.erased ? 0.0 : info.constantValue.has_value() ? info.constantValue.value() : state.currentVal->get_num();
+				return 0;
+			}
+
+			result_type visit_primitive(bool& obj, const PrimitiveInfo<bool>& info) {
+				obj = info.erased ? false : info.constantValue.has_value() ? info.constantValue.value() : state.currentVal->get_bool();
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Vector2& obj, const PrimitiveInfo<ucsl::math::Vector2>& info) {
+				read_vector(obj, { "x", "y" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Vector3& obj, const PrimitiveInfo<ucsl::math::Vector3>& info) {
+				read_vector(obj, { "x", "y", "z" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Position& obj, const PrimitiveInfo<ucsl::math::Position>& info) {
+				read_vector(obj, { "x", "y", "z" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Vector4& obj, const PrimitiveInfo<ucsl::math::Vector4>& info) {
+				read_vector(obj, { "x", "y", "z", "w" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Quaternion& obj, const PrimitiveInfo<ucsl::math::Quaternion>& info) {
+				read_vector(obj.coeffs(), { "x", "y", "z", "w" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Matrix34& obj, const PrimitiveInfo<ucsl::math::Matrix34>& info) {
+				read_matrix(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Matrix44& obj, const PrimitiveInfo<ucsl::math::Matrix44>& info) {
+				read_matrix(obj);
+				return 0;
+			}
+
+			template<ucsl::colors::ChannelOrder order>
+			result_type visit_primitive(ucsl::colors::Color8<order>& obj, const PrimitiveInfo<ucsl::colors::Color8<order>>& info) {
+				obj.r = static_cast<uint8_t>(get(state.currentVal, "r")->get_uint());
+				obj.g = static_cast<uint8_t>(get(state.currentVal, "g")->get_uint());
+				obj.b = static_cast<uint8_t>(get(state.currentVal, "b")->get_uint());
+				obj.a = static_cast<uint8_t>(get(state.currentVal, "a")->get_uint());
+				return 0;
+			}
+
+			template<ucsl::colors::ChannelOrder order>
+			result_type visit_primitive(ucsl::colors::Colorf<order>& obj, const PrimitiveInfo<ucsl::colors::Colorf<order>>& info) {
+				obj.r = static_cast<float>(get(state.currentVal, "r")->get_num());
+				obj.g = static_cast<float>(get(state.currentVal, "g")->get_num());
+				obj.b = static_cast<float>(get(state.currentVal, "b")->get_num());
+				obj.a = static_cast<float>(get(state.currentVal, "a")->get_num());
+				return 0;
+			}
+
+			// Strings in the document aren't null terminated.
+			result_type visit_primitive(ucsl::objectids::ObjectIdV1& obj, const PrimitiveInfo<ucsl::objectids::ObjectIdV1>& info) {
+				util::fromGUID(obj, std::string{ state.currentVal->get_view() }.c_str());
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::objectids::ObjectIdV2& obj, const PrimitiveInfo<ucsl::objectids::ObjectIdV2>& info) {
+				util::fromGUID(obj, std::string{ state.currentVal->get_view() }.c_str());
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::strings::VariableString& obj, const PrimitiveInfo<ucsl::strings::VariableString>& info) {
+				auto buffer = (const char**)addptr(&obj, 0x0);
+				auto allocator = (void**)addptr(&obj, 0x8);
+				if (state.currentVal->get_len() == 0)
+					*buffer = nullptr;
+				else
+					visit_primitive(*buffer, PrimitiveInfo<const char*>{});
+				*allocator = nullptr;
+				return 0;
+			}
+
+			result_type visit_primitive(const char*& obj, const PrimitiveInfo<const char*>& info) {
+				if (!state.currentVal->is_str())
+					obj = nullptr;
+				else {
+					const char* str = state.currentVal->get_str();
+					size_t length = state.currentVal->get_len();
+
+					// The target is zeroed, so this also terminates the string.
+					enqueue_block(obj, [length]() { return BlockAllocationData{ length + 1, 1 }; }, [str, length](const char* target) {
+						memcpy(const_cast<char*>(target), str, length);
+						return 0;
+					});
+				}
+				return 0;
+			}
+
+			result_type visit_primitive(void*& obj, const PrimitiveInfo<void*>& info) {
+				return 0;
+			}
+
+			template<typename T, typename O>
+			result_type visit_enum(T& obj, const EnumInfo<O>& info) {
+				if (auto index = getEnumLookup(info.options).getIndex(state.currentVal->get_view())) {
+					obj = static_cast<T>(index.value());
+					return 0;
+				}
+				assert("unhandled enum");
+				return 0;
+			}
+
+			template<typename T, typename O>
+			result_type visit_flags(T& obj, const FlagsInfo<O>& info) {
+				return visit_primitive(obj, PrimitiveInfo<T>{});
+			}
+
+			template<typename F>
+			void enqueue_items(opaque_obj*& buffer, size_t arrsize, const ArrayInfo& info, F f) {
+				enqueue_block(buffer, [info, arrsize]() { return BlockAllocationData{ arrsize * info.itemSize, info.itemAlignment }; }, [this, itemSize = info.itemSize, f](opaque_obj* target) {
+					for (size_t i = 0; i < state.currentVal->size(); i++)
+						with_val(state.currentVal->item(i), [target, itemSize, i, f]() { return f(*addptr(target, i * itemSize)); });
+					return 0;
+				});
+			}
+
+			template<typename F, typename C, typename D, typename A>
+			result_type visit_array(A& arr, const ArrayInfo& info, C c, D d, F f) {
+				size_t arrsize = state.currentVal->size();
+				auto buffer = (opaque_obj**)addptr(&arr.underlying, 0x0);
+				auto length = (unsigned long long*)addptr(&arr.underlying, 0x8);
+				auto capacity = (unsigned long long*)addptr(&arr.underlying, 0x10);
+				auto allocator = (void**)addptr(&arr.underlying, 0x18);
+				if (arrsize == 0)
+					*buffer = nullptr;
+				else
+					enqueue_items(*buffer, arrsize, info, f);
+				*length = arrsize;
+				*capacity = arrsize;
+				*allocator = nullptr;
+				return 0;
+			}
+
+			template<typename F, typename C, typename D, typename A>
+			result_type visit_tarray(A& arr, const ArrayInfo& info, C c, D d, F f) {
+				size_t arrsize = state.currentVal->size();
+				auto buffer = (opaque_obj**)addptr(&arr.underlying, 0x0);
+				auto length = (unsigned long long*)addptr(&arr.underlying, 0x8);
+				auto capacity = (long long*)addptr(&arr.underlying, 0x10);
+				if (arrsize == 0)
+					*buffer = nullptr;
+				else
+					enqueue_items(*buffer, arrsize, info, f);
+				*length = arrsize;
+				*capacity = arrsize;
+				return 0;
+			}
+
+			template<typename F, typename A, typename S>
+			result_type visit_pointer(opaque_obj*& obj, const PointerInfo<A, S>& info, F f) {
+				if (state.currentVal->is_nil())
+					obj = nullptr;
+				else
+					enqueue_block(obj, [info]() { return BlockAllocationData{ info.getTargetSize(), info.getTargetAlignment() }; }, [f](opaque_obj* target) { return f(*target); });
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_carray(opaque_obj* obj, const CArrayInfo& info, F f) {
+				assert(state.currentVal->size() == info.size);
+				for (size_t i = 0; i < state.currentVal->size(); i++)
+					with_val(state.currentVal->item(i), [f, obj, i, stride = info.stride]() { return f(*addptr(obj, i * stride)); });
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_union(opaque_obj& obj, const UnionInfo& info, F f) {
+				return f(obj);
+			}
+
+			template<typename F>
+			result_type visit_type(opaque_obj& obj, const TypeInfo& info, F f) {
+				return f(obj);
+			}
+
+			template<typename F>
+			result_type visit_field(opaque_obj& obj, const FieldInfo& info, F f) {
+				const value_type* val = state.currentStruct != nullptr && state.currentStruct->is_for(state.currentVal) ? state.currentStruct->get(info.name) : get(state.currentVal, info.name);
+
+				with_val(val, [f, &obj]() { return f(obj); });
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_base_struct(opaque_obj& obj, const StructureInfo& info, F f) {
+				return f(obj);
+			}
+
+			template<typename F>
+			result_type visit_struct(opaque_obj& obj, const StructureInfo& info, F f) {
+				if (!state.currentVal->is_map())
+					return f(obj);
+
+				FieldCursor cursor{ state.currentVal };
+				FieldCursor* prevStruct = state.currentStruct;
+				state.currentStruct = &cursor;
+				result_type res = f(obj);
+				state.currentStruct = prevStruct;
+				return res;
+			}
+
+			template<typename F>
+			result_type visit_root(opaque_obj& obj, const RootInfo& info, F f) {
+				opaque_obj* ptr;
+				with_val(state.deserializer.doc.get_root(), [f, this, &ptr, &info]() {
+					enqueue_block(ptr, [info]() { return BlockAllocationData{ info.size, info.alignment }; }, [f](opaque_obj* target) {
+						f(*target);
+						return 0;
+					});
+					return 0;
+				});
+				state.worker.processQueuedBlocks();
+				return 0;
+			}
+		};
+
+		template<typename Allocator>
+		struct OperationState {
+			MsgPackDeserializer& deserializer;
+			const value_type* currentVal{ &nilValue };
+			FieldCursor* currentStruct{};
+			BlobWorker<opaque_obj*, Allocator, ArenaDeferredAllocationBlobWorkerScheduler> worker{};
+		};
+
+		using MeasureState = OperationState<HeapBlockAllocator<GameInterface, opaque_obj>>;
+		using WriteState = OperationState<SequentialMemoryBlockAllocator<opaque_obj>>;
+
+		MeasureState measureState{ *this };
+		WriteState writeState{ *this };
+
+	public:
+		MsgPackDeserializer(const char* filename) : filename{ filename } {
+		}
+
+		template<typename T, typename R>
+		T* deserialize(R refl) {
+			file = util::mapped_file{ filename };
+
+			if (!doc.parse(file.data(), file.size())) {
+				std::cout << "Error reading msgpack: " << doc.get_error() << std::endl;
+				return nullptr;
+			}
+
+			T* stub{};
+			ucsl::reflection::traversals::traversal<OperationBase<MeasureState>> measureOp{ measureState };
+			measureOp.operator()<T>(*stub, refl);
+			size_t size = measureState.worker.allocator.sizeRequired;
+
+			result = (opaque_obj*)GameInterface::AllocatorSystem::get_allocator()->Alloc(size, 16);
+			writeState.worker.allocator.origin = result;
+
+			memset(result, 0, size);
+
+			ucsl::reflection::traversals::traversal<OperationBase<WriteState>> writeOp{ writeState };
+			writeOp.operator()<T>(*(T*)result, refl);
+
+			return (T*)result;
+		}
+	};
+}
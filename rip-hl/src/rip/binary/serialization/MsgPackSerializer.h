@@ -0,0 +1,281 @@
+#pragma once
+#include <ucsl-reflection/reflections/basic-types.h>
+#include <ucsl-reflection/traversals/types.h>
+#include <ucsl-reflection/traversals/traversal.h>
+#include <ucsl-reflection/opaque.h>
+#include <rip/util/msgpack-writer.h>
+#include <rip/util/object-id-guids.h>
+#include "EnumLookup.h"
+
+namespace rip::binary {
+	using namespace ucsl::reflection;
+	using namespace ucsl::reflection::traversals;
+
+	/*
+	 * Writes the same structure as JsonSerializer, encoded as MessagePack.
+	 * Floats are written as 32-bit floats, so they round trip exactly.
+	 */
+	template<bool arrayVectors = false>
+	class MsgPackSerializer {
+		util::msgpack_writer& writer;
+
+		class SerializeChunk {
+		public:
+			constexpr static size_t arity = 1;
+			typedef int result_type;
+
+			MsgPackSerializer& serializer;
+
+			SerializeChunk(MsgPackSerializer& serializer) : serializer{ serializer } {}
+
+			template<typename T>
+			void write_vector(const T& obj, std::initializer_list<const char*> names) {
+				if constexpr (arrayVectors) {
+					serializer.writer.begin_array();
+					for (size_t i = 0; i < obj.rows(); i++)
+						for (size_t j = 0; j < obj.cols(); j++)
+							serializer.writer.fp32(obj(i, j));
+					serializer.writer.end_array();
+				}
+				else {
+					size_t i = 0;
+
+					serializer.writer.begin_map();
+					for (auto* name : names) {
+						serializer.writer.key(name);
+						serializer.writer.fp32(obj(i++));
+					}
+					serializer.writer.end_map();
+				}
+			}
+
+			template<typename T>
+			void write_matrix(const T& obj) {
+				serializer.writer.begin_array();
+				for (size_t i = 0; i < obj.rows(); i++)
+					for (size_t j = 0; j < obj.cols(); j++)
+						serializer.writer.fp32(obj(i, j));
+				serializer.writer.end_array();
+			}
+
+			template<std::integral T, std::enable_if_t<std::is_signed_v<T>, bool> = true>
+			result_type visit_primitive(T& obj, const PrimitiveInfo<T>& info) {
+				serializer.writer.sint(obj);
+				return 0;
+			}
+
+			template<std::integral T, std::enable_if_t<!std::is_signed_v<T>, bool> = true>
+			result_type visit_primitive(T& obj, const PrimitiveInfo<T>& info) {
+				serializer.writer.uint(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(float& obj, const PrimitiveInfo<float>& info) {
+				serializer.writer.fp32(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(double& obj, const PrimitiveInfo<double>& info) {
+				serializer.writer.real(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(bool& obj, const PrimitiveInfo<bool>& info) {
+				serializer.writer.boolean(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Vector2& obj, const PrimitiveInfo<ucsl::math::Vector2>& info) {
+				write_vector(obj, { "x", "y" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Vector3& obj, const PrimitiveInfo<ucsl::math::Vector3>& info) {
+				write_vector(obj, { "x", "y", "z" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Position& obj, const PrimitiveInfo<ucsl::math::Position>& info) {
+				write_vector(obj, { "x", "y", "z" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Vector4& obj, const PrimitiveInfo<ucsl::math::Vector4>& info) {
+				write_vector(obj, { "x", "y", "z", "w" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Quaternion& obj, const PrimitiveInfo<ucsl::math::Quaternion>& info) {
+				// Quaternion coefficients are stored as x, y, z, w.
+				write_vector(obj.coeffs(), { "x", "y", "z", "w" });
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Matrix34& obj, const PrimitiveInfo<ucsl::math::Matrix34>& info) {
+				write_matrix(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::math::Matrix44& obj, const PrimitiveInfo<ucsl::math::Matrix44>& info) {
+				write_matrix(obj);
+				return 0;
+			}
+
+			template<ucsl::colors::ChannelOrder order>
+			result_type visit_primitive(ucsl::colors::Color8<order>& obj, const PrimitiveInfo<ucsl::colors::Color8<order>>& info) {
+				serializer.writer.begin_map();
+				serializer.writer.key("r");
+				serializer.writer.uint(obj.r);
+				serializer.writer.key("g");
+				serializer.writer.uint(obj.g);
+				serializer.writer.key("b");
+				serializer.writer.uint(obj.b);
+				serializer.writer.key("a");
+				serializer.writer.uint(obj.a);
+				serializer.writer.end_map();
+				return 0;
+			}
+
+			template<ucsl::colors::ChannelOrder order>
+			result_type visit_primitive(ucsl::colors::Colorf<order>& obj, const PrimitiveInfo<ucsl::colors::Colorf<order>>& info) {
+				serializer.writer.begin_map();
+				serializer.writer.key("r");
+				serializer.writer.fp32(obj.r);
+				serializer.writer.key("g");
+				serializer.writer.fp32(obj.g);
+				serializer.writer.key("b");
+				serializer.writer.fp32(obj.b);
+				serializer.writer.key("a");
+				serializer.writer.fp32(obj.a);
+				serializer.writer.end_map();
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::objectids::ObjectIdV1& obj, const PrimitiveInfo<ucsl::objectids::ObjectIdV1>& info) {
+				char guid[39];
+				util::toGUID(obj, guid);
+				serializer.writer.string(guid);
+				return 0;
+			}
+
+			result_type visit_primitive(ucsl::objectids::ObjectIdV2& obj, const PrimitiveInfo<ucsl::objectids::ObjectIdV2>& info) {
+				char guid[39];
+				util::toGUID(obj, guid);
+				serializer.writer.string(guid);
+				return 0;
+			}
+
+			// Null strings are left out entirely, as in JSON output.
+			result_type visit_primitive(ucsl::strings::VariableString& obj, const PrimitiveInfo<ucsl::strings::VariableString>& info) {
+				if (obj.c_str() != nullptr)
+					serializer.writer.string(obj.c_str());
+				return 0;
+			}
+
+			result_type visit_primitive(const char*& obj, const PrimitiveInfo<const char*>& info) {
+				if (obj != nullptr)
+					serializer.writer.string(obj);
+				return 0;
+			}
+
+			result_type visit_primitive(void*& obj, const PrimitiveInfo<void*>& info) {
+				serializer.writer.string("TODO");
+				return 0;
+			}
+
+			template<typename T, typename O>
+			result_type visit_enum(T& obj, const EnumInfo<O>& info) {
+				if (const char* name = getEnumLookup(info.options).getName(static_cast<long long>(obj)))
+					serializer.writer.string(name);
+				return 0;
+			}
+
+			template<typename T, typename O>
+			result_type visit_flags(T& obj, const FlagsInfo<O>& info) {
+				return visit_primitive(obj, PrimitiveInfo<T>{});
+			}
+
+			template<typename F, typename C, typename D, typename A>
+			result_type visit_array(A& arr, const ArrayInfo& info, C c, D d, F f) {
+				serializer.writer.begin_array();
+				for (auto& obj : arr)
+					f(obj);
+				serializer.writer.end_array();
+				return 0;
+			}
+
+			template<typename F, typename C, typename D, typename A>
+			result_type visit_tarray(A& arr, const ArrayInfo& info, C c, D d, F f) {
+				serializer.writer.begin_array();
+				for (auto& obj : arr)
+					f(obj);
+				serializer.writer.end_array();
+				return 0;
+			}
+
+			template<typename F, typename A, typename S>
+			result_type visit_pointer(opaque_obj*& obj, const PointerInfo<A, S>& info, F f) {
+				if (obj == nullptr)
+					serializer.writer.nil();
+				else
+					f(*obj);
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_carray(opaque_obj* obj, const CArrayInfo& info, F f) {
+				serializer.writer.begin_array();
+				for (size_t i = 0; i < info.size; i++)
+					f(*addptr(obj, i * info.stride));
+				serializer.writer.end_array();
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_union(opaque_obj& obj, const UnionInfo& info, F f) {
+				return f(obj);
+			}
+
+			template<typename F>
+			result_type visit_type(opaque_obj& obj, const TypeInfo& info, F f) {
+				return f(obj);
+			}
+
+			template<typename F>
+			result_type visit_field(opaque_obj& obj, const FieldInfo& info, F f) {
+				if (!info.erased) {
+					serializer.writer.key(info.name);
+					f(obj);
+				}
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_base_struct(opaque_obj& obj, const StructureInfo& info, F f) {
+				return f(obj);
+			}
+
+			template<typename F>
+			result_type visit_struct(opaque_obj& obj, const StructureInfo& info, F f) {
+				serializer.writer.begin_map();
+				f(obj);
+				serializer.writer.end_map();
+				return 0;
+			}
+
+			template<typename F>
+			result_type visit_root(opaque_obj& obj, const RootInfo& info, F f) {
+				return f(obj);
+			}
+		};
+
+	public:
+		MsgPackSerializer(util::msgpack_writer& writer) : writer{ writer } {}
+
+		template<typename T, typename R>
+		void serialize(T& data, R refl) {
+			ucsl::reflection::traversals::traversal<SerializeChunk>{ *this }(data, refl);
+			writer.flush();
+		}
+	};
+}
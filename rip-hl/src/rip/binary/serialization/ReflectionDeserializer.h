@@ -1,5 +1,10 @@
 #pragma once
 #include <type_traits>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <string_view>
+#include <cstring>
 #include <ucsl-reflection/reflections/basic-types.h>
 #include <ucsl-reflection/traversals/types.h>
 #include <ucsl-reflection/traversals/traversal.h>
@@ -27,8 +32,93 @@ namespace rip::binary {
 				size_t size;
 			};
 
+			size_t offset{};
 			std::optional<Resolution> resolved{};
-			std::vector<opaque_obj**> ptrs{};
+			unsigned int firstPtr{ noPtr }; // head of this offset's list in KnownOffsetTable::ptrs.
+			std::string_view string{}; // only set for offsets that were read as strings.
+
+			static constexpr unsigned int noPtr = 0xFFFFFFFF;
+		};
+
+		// Open addressing hash table (linear probing) of DisambiguatedOffsets.
+		// Entries are stored densely and referred to by index, and all back-references share one pool of linked list nodes.
+		class KnownOffsetTable {
+		public:
+			struct PtrRef {
+				opaque_obj** ptr;
+				unsigned int next;
+			};
+
+		private:
+			std::vector<DisambiguatedOffset> entries{};
+			std::vector<unsigned int> slots{}; // entry index + 1, 0 is empty.
+			std::vector<PtrRef> ptrs{};
+			unsigned int slotBits{};
+
+			inline size_t getSlot(size_t offset) const {
+				return static_cast<size_t>((static_cast<uint64_t>(offset) * 0x9E3779B97F4A7C15ull) >> (64 - slotBits));
+			}
+
+			void grow() {
+				slotBits = slotBits == 0 ? 10 : slotBits + 1;
+				slots.assign(static_cast<size_t>(1) << slotBits, 0);
+
+				size_t mask = slots.size() - 1;
+
+				for (unsigned int i = 0; i < entries.size(); i++) {
+					size_t slot = getSlot(entries[i].offset);
+
+					while (slots[slot] != 0)
+						slot = (slot + 1) & mask;
+
+					slots[slot] = i + 1;
+				}
+			}
+
+		public:
+			unsigned int findOrInsert(size_t offset) {
+				// Keep the load factor at or below 1/2.
+				if ((entries.size() + 1) * 2 > slots.size())
+					grow();
+
+				size_t mask = slots.size() - 1;
+				size_t slot = getSlot(offset);
+
+				while (slots[slot] != 0) {
+					unsigned int index = slots[slot] - 1;
+
+					if (entries[index].offset == offset)
+						return index;
+
+					slot = (slot + 1) & mask;
+				}
+
+				unsigned int index = static_cast<unsigned int>(entries.size());
+
+				entries.push_back(DisambiguatedOffset{ offset });
+				slots[slot] = index + 1;
+
+				return index;
+			}
+
+			inline DisambiguatedOffset& operator[](unsigned int index) {
+				return entries[index];
+			}
+
+			inline void addPtr(unsigned int index, opaque_obj** ptr) {
+				ptrs.push_back(PtrRef{ ptr, entries[index].firstPtr });
+				entries[index].firstPtr = static_cast<unsigned int>(ptrs.size() - 1);
+			}
+
+			template<typename F>
+			inline void forEachPtr(unsigned int index, F f) {
+				for (unsigned int i = entries[index].firstPtr; i != DisambiguatedOffset::noPtr; i = ptrs[i].next)
+					f(ptrs[i].ptr);
+			}
+
+			inline const std::vector<PtrRef>& getAllPtrs() const {
+				return ptrs;
+			}
 		};
 
 		template<typename OpState>
@@ -49,20 +139,17 @@ namespace rip::binary {
 					return;
 
 				size_t off = offset.value();
+				unsigned int index = state.knownOffsets.findOrInsert(off);
 
-				auto it = state.knownOffsets.find(off);
-				if (it != state.knownOffsets.end())
-					it->second.ptrs.push_back(&(opaque_obj*&)ptr);
-				else
-					state.knownOffsets.emplace(off, DisambiguatedOffset{ std::nullopt, { &(opaque_obj*&)ptr } });
+				state.knownOffsets.addPtr(index, &(opaque_obj*&)ptr);
 
 				state.worker.enqueueBlock(
-					[this, off, allocationDataGetter, &ptr]() {
-						auto it = state.knownOffsets.find(off);
-						if (!it->second.resolved.has_value())
+					[this, index, allocationDataGetter, &ptr]() {
+						auto& disamb = state.knownOffsets[index];
+						if (!disamb.resolved.has_value())
 							return true;
 
-						auto& resolved = it->second.resolved.value();
+						auto& resolved = disamb.resolved.value();
 
 						if (resolved.size < allocationDataGetter().size)
 							return true;
@@ -71,13 +158,9 @@ namespace rip::binary {
 
 						return false;
 					},
-					[this, off, allocationDataGetter](opaque_obj* target) {
-						auto& disamb = state.knownOffsets.find(off)->second;
-
-						for (opaque_obj** ptr : disamb.ptrs)
-							*ptr = target;
-
-						disamb.resolved = { target, allocationDataGetter().size };
+					[this, index, allocationDataGetter](opaque_obj* target) {
+						state.knownOffsets.forEachPtr(index, [target](opaque_obj** ptr) { *ptr = target; });
+						state.knownOffsets[index].resolved = { target, allocationDataGetter().size };
 					},
 					allocationDataGetter,
 					[this, off, processFunc](opaque_obj* target, size_t alignment) {
@@ -121,17 +204,16 @@ namespace rip::binary {
 					if (!offset.has_value())
 						obj = nullptr;
 					else {
-						std::string temp{};
+						// Every distinct string is only scanned once. The view points into the input buffer.
+						auto& known = state.knownOffsets[state.knownOffsets.findOrInsert(offset.value())];
 
-						auto pos = state.deserializer.backend.tellg();
-						state.deserializer.backend.seekg(offset.value());
-						state.deserializer.backend.read_string(temp);
-						state.deserializer.backend.seekg(pos);
+						if (known.string.data() == nullptr)
+							known.string = state.deserializer.backend.view_string(offset.value());
+
+						std::string_view str = known.string;
 
-						enqueueBlock(obj, offset, [size = temp.size() + 1]() { return BlockAllocationData{ size, 1 }; }, [this](opaque_obj* target) {
-							std::string str{};
-							state.deserializer.backend.read_string(str);
-							strcpy_s(reinterpret_cast<char*>(target), str.size() + 1, str.c_str());
+						enqueueBlock(obj, offset, [size = str.size() + 1]() { return BlockAllocationData{ size, 1 }; }, [str](opaque_obj* target) {
+							memcpy(target, str.data(), str.size());
 						});
 					}
 				//}
@@ -160,9 +242,11 @@ namespace rip::binary {
 					return 0;
 				}
 
-				auto& known = state.knownOffsets[offset.value()];
+				unsigned int index = state.knownOffsets.findOrInsert(offset.value());
 
-				known.ptrs.push_back(&(opaque_obj*&)obj);
+				state.knownOffsets.addPtr(index, &(opaque_obj*&)obj);
+
+				auto& known = state.knownOffsets[index];
 				if (known.resolved.has_value())
 					obj = known.resolved.value().ptr;
 				return 0;
@@ -316,34 +400,33 @@ namespace rip::binary {
 		template<typename Allocator>
 		struct OperationState {
 			ReflectionDeserializer& deserializer;
-			BlobWorker<ucsl::reflection::opaque_obj*, Allocator, DeferredAllocationBlobWorkerScheduler> worker{};
-			std::map<size_t, DisambiguatedOffset> knownOffsets{};
+			BlobWorker<ucsl::reflection::opaque_obj*, Allocator, ArenaDeferredAllocationBlobWorkerScheduler> worker{};
+			KnownOffsetTable knownOffsets{};
 		};
 
-		using MeasureState = OperationState<HeapBlockAllocator<GameInterface, opaque_obj>>;
-		using WriteState = OperationState<SequentialMemoryBlockAllocator<opaque_obj>>;
+		using ArenaState = OperationState<ArenaBlockAllocator<GameInterface, opaque_obj>>;
 
-		MeasureState measureState{ *this };
-		WriteState writeState{ *this };
+		ArenaState state{ *this };
 		opaque_obj* result{};
 
 	public:
 		ReflectionDeserializer(Backend& backend) : backend{ backend } { }
 
+		// Reads everything into an arena in a single traversal, then moves it into one allocation and fixes up the pointers.
 		template<typename T, typename R>
 		T* deserialize(R refl) {
 			T* stub{};
-			ucsl::reflection::traversals::traversal<OperationBase<MeasureState>> measureOp{ measureState };
-			measureOp.operator()<T>(*stub, refl);
-			size_t size = measureState.worker.allocator.sizeRequired;
+			ucsl::reflection::traversals::traversal<OperationBase<ArenaState>> op{ state };
+			op.operator()<T>(*stub, refl);
+
+			auto& allocator = state.worker.allocator;
 
-			result = (opaque_obj*)GameInterface::AllocatorSystem::get_allocator()->Alloc(size, 16);
-			writeState.worker.allocator.origin = result;
+			result = allocator.commit();
 
-			memset(result, 0, size);
+			for (auto& ref : state.knownOffsets.getAllPtrs())
+				allocator.relocate(ref.ptr);
 
-			ucsl::reflection::traversals::traversal<OperationBase<WriteState>> writeOp{ writeState };
-			writeOp.operator()<T>(*(T*)result, refl);
+			allocator.release();
 
 			return (T*)result;
 		}
@@ -1,20 +1,41 @@
 #pragma once
 #include <type_traits>
+#include <map>
+#include <optional>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
 #include <ucsl-reflection/reflections/basic-types.h>
 #include <ucsl-reflection/traversals/types.h>
 #include <ucsl-reflection/traversals/traversal.h>
 #include <ucsl-reflection/opaque.h>
 #include <rip/binary/types.h>
+#include <rip/binary/stream.h>
+#include <rip/util/parallel.h>
 #include "BlobWorker.h"
+#include "TaskQueue.h"
 #include <iostream>
 
 namespace rip::binary {
 	using namespace ucsl::reflection;
 	using namespace ucsl::reflection::traversals;
 
+	struct SerializerOptions {
+		// Number of threads used to serialize blocks. 0 uses all cores. The output is identical for any value.
+		unsigned int jobs{ 1 };
+		// Write blocks without outgoing pointers only once if their contents are identical, even if they come from different objects.
+		bool deduplicate{};
+	};
+
 	template<typename Backend>
 	class ReflectionSerializer {
 		Backend& backend;
+		unsigned int jobs;
+		bool deduplicate;
 
 		// We keep the buffer size as well, since sometimes an earlier reference serialized a smaller slice
 		// of the buffer, and in that case we can't simply point back to this already stored version.
@@ -25,59 +46,583 @@ namespace rip::binary {
 			size_t bufferSize;
 		};
 
-		std::map<const void*, DisambiguatedPointer> knownPtrs{};
+		// Known buffers, sorted by address, answering both exact and containment lookups in O(log n).
+		// Every buffer also remembers the buffer that reaches furthest among those containing its start address (its "root").
+		// Any buffer containing an address must contain the start of the closest buffer before it, so checking that buffer's
+		// root is enough to find a containing buffer.
+		class KnownPointerIndex {
+			struct Entry : DisambiguatedPointer {
+				const void* rootStart;
+				Entry* root;
+
+				size_t end() const {
+					return reinterpret_cast<size_t>(rootStart) + root->bufferSize;
+				}
+			};
+
+			std::map<const void*, Entry> entries{};
+
+		public:
+			const DisambiguatedPointer* find(const void* ptr) const {
+				auto it = entries.find(ptr);
+				return it == entries.end() ? nullptr : &it->second;
+			}
+
+			// Finds the offset of an address inside any known buffer.
+			std::optional<size_t> resolve(const void* ptr) const {
+				auto it = entries.upper_bound(ptr);
+
+				if (it == entries.begin())
+					return std::nullopt;
+
+				auto& entry = std::prev(it)->second;
+				size_t addr = reinterpret_cast<size_t>(ptr);
+
+				if (addr >= entry.end())
+					return std::nullopt;
+
+				return entry.root->offset + (addr - reinterpret_cast<size_t>(entry.rootStart));
+			}
+
+			// Adds a buffer, or replaces a smaller buffer at the same address.
+			void insert(const void* ptr, size_t offset, size_t bufferSize) {
+				auto [it, inserted] = entries.insert_or_assign(ptr, Entry{ { offset, bufferSize }, ptr, nullptr });
+				Entry& entry = it->second;
+				size_t start = reinterpret_cast<size_t>(ptr);
+				size_t end = start + bufferSize;
+
+				entry.root = &entry;
+
+				if (it != entries.begin()) {
+					auto& prev = std::prev(it)->second;
+
+					if (prev.end() > start && prev.end() > end) {
+						entry.rootStart = prev.rootStart;
+						entry.root = prev.root;
+					}
+				}
+
+				size_t rootEnd = entry.end();
+
+				for (auto inner = std::next(it); inner != entries.end() && reinterpret_cast<size_t>(inner->first) < end; inner++) {
+					if (inner->second.end() < rootEnd) {
+						inner->second.rootStart = entry.rootStart;
+						inner->second.root = entry.root;
+					}
+				}
+			}
+		};
+
+		KnownPointerIndex knownPtrs{};
+
+		/*
+		 * When serializing with multiple jobs, the blocks are processed one generation at a time: every block
+		 * of a generation is first written in parallel into its own BlockRecording, and the recordings are then
+		 * stitched into the backend in order. Offsets to child blocks and back-references are not known while
+		 * recording, so they are written as placeholders and only resolved while stitching. Since child blocks
+		 * are allocated during stitching in exactly the same order as a serial run would, the output is identical.
+		 *
+		 * When deduplicating, blocks are recorded before they are allocated instead, so that blocks without any
+		 * outgoing pointers (other than strings) can be compared with earlier blocks by content.
+		 */
+		struct BlockRecording;
+
+		class recording_ostream : public binary_ostream<typename Backend::address_type, Backend::byte_order> {
+			using base = binary_ostream<typename Backend::address_type, Backend::byte_order>;
+
+			BlockRecording& recording;
+
+		public:
+			recording_ostream(fast_ostream& raw_stream, BlockRecording& recording) : base{ raw_stream }, recording{ recording } {}
+
+			template<typename T>
+			void write(const T& obj) {
+				base::write(obj);
+			}
+
+			template<typename T>
+			void write(const offset_t<T>& obj) {
+				recording.events.push_back({ BlockRecording::Event::Type::OFFSET, this->tellp(), obj.has_value() ? obj.value() : BlockRecording::nullOffset });
+				base::write(static_cast<typename Backend::address_type>(0));
+			}
+
+			void write(const char* const& obj) {
+				recording.events.push_back({ BlockRecording::Event::Type::STRING, this->tellp(), 0, obj });
+				base::write(static_cast<typename Backend::address_type>(0));
+			}
+		};
+
+		struct BlockRecording {
+			static constexpr size_t placeholderTag = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+			static constexpr size_t nullOffset = ~static_cast<size_t>(0);
+
+			struct Event {
+				enum class Type {
+					CHILD_BLOCK,
+					BACKREFERENCE,
+					OFFSET,
+					STRING,
+				};
+
+				Type type;
+				size_t pos;
+				size_t value; // CHILD_BLOCK: index into children, OFFSET: placeholder or nullOffset.
+				const void* ptr{}; // BACKREFERENCE: referenced address, STRING: the string.
+			};
+
+			struct ChildBlock {
+				const void* ptr;
+				size_t bufferSize;
+				size_t alignment;
+				ArenaFunction processFunc;
+				std::shared_ptr<BlockRecording> recording{};
+			};
+
+			// Most recordings only have a handful of children, so keep their arenas small.
+			static constexpr size_t functionChunkSize = 1024;
+
+			size_t base;
+			size_t maxAlignment{ 1 }; // The recording is only valid at offsets aligned to this.
+			fast_ostream raw_stream;
+			recording_ostream stream{ raw_stream, *this };
+			std::vector<Event> events{};
+			std::vector<ChildBlock> children{};
+			FunctionArena functions{ functionChunkSize };
+
+			BlockRecording(size_t offset) : base{ offset }, raw_stream{ offset } {}
+
+			bool isLeaf() const {
+				for (auto& event : events)
+					if (event.type == Event::Type::CHILD_BLOCK || event.type == Event::Type::BACKREFERENCE)
+						return false;
+
+				return true;
+			}
+
+			// FNV-1a hash of the block's bytes and its string relocations, which together determine its final contents.
+			uint64_t contentHash() const {
+				uint64_t hash{ 0xcbf29ce484222325ull };
+
+				auto hashBytes = [&hash](const void* data, size_t size) {
+					for (size_t i = 0; i < size; i++)
+						hash = (hash ^ static_cast<const unsigned char*>(data)[i]) * 0x100000001b3ull;
+				};
+
+				hashBytes(raw_stream.data(), raw_stream.size());
+
+				for (auto& event : events) {
+					if (event.type == Event::Type::STRING) {
+						size_t pos = event.pos - base;
+
+						hashBytes(&pos, sizeof(pos));
+						hashBytes(event.ptr == nullptr ? "" : event.ptr, event.ptr == nullptr ? 1 : strlen(static_cast<const char*>(event.ptr)) + 1);
+					}
+				}
+
+				return hash;
+			}
+
+			template<typename F>
+			size_t addChildBlock(const void* ptr, size_t bufferSize, size_t alignment, F&& processFunc) {
+				events.push_back({ Event::Type::CHILD_BLOCK, 0, children.size() });
+				children.push_back({ ptr, bufferSize, alignment, functions.create(std::forward<F>(processFunc)) });
+				return placeholderTag | (events.size() - 1);
+			}
+
+			size_t addBackReference(const void* ptr) {
+				events.push_back({ Event::Type::BACKREFERENCE, 0, 0, ptr });
+				return placeholderTag | (events.size() - 1);
+			}
+		};
+
+		// Forwards writes to the block recording of the current thread if there is one, and to the backend otherwise.
+		class Output {
+			Backend& backend;
+			BlockRecording* recording;
+
+		public:
+			Output(Backend& backend, BlockRecording* recording) : backend{ backend }, recording{ recording } {}
+
+			template<typename T>
+			void write(T&& obj) {
+				if (recording)
+					recording->stream.write(std::forward<T>(obj));
+				else
+					backend.write(std::forward<T>(obj));
+			}
+
+			void write_string(const char* str) {
+				if (recording)
+					recording->stream.write_string(str);
+				else
+					backend.write_string(str);
+			}
+
+			void write_padding(size_t alignment) {
+				if (recording) {
+					recording->maxAlignment = std::max(recording->maxAlignment, alignment);
+					recording->stream.write_padding(alignment);
+				}
+				else
+					backend.write_padding(alignment);
+			}
+
+			void write_padding_bytes(size_t size) {
+				if (recording)
+					recording->stream.write_padding_bytes(size);
+				else
+					backend.write_padding_bytes(size);
+			}
+
+			size_t tellp() const {
+				return recording ? recording->stream.tellp() : backend.tellp();
+			}
+		};
 
 		class SerializeChunk {
 		public:
 			constexpr static size_t arity = 1;
 			typedef int result_type;
 
+			struct PendingBlock {
+				size_t offset;
+				size_t bufferSize;
+				size_t alignment;
+				ArenaFunction processFunc;
+				std::shared_ptr<BlockRecording> recording{};
+			};
+
+			// Number of blocks recorded before they are stitched, to bound the memory used by recordings.
+			static constexpr size_t recordingBatchSize = 4096;
+
 			ReflectionSerializer& serializer;
-			BlobWorker<> worker;
-			size_t dbgStructStartLoc{};
-			void* currentStructAddr{};
+			BlobWorker<size_t, SequentialBlockAllocator, ArenaDeferredBlobWorkerScheduler> worker;
+			// Leaf blocks that have been allocated, by content hash. Hash matches are confirmed by comparing the block
+			// with its recording if it is still pending, and with the backend's buffered output otherwise.
+			struct KnownBlock {
+				size_t offset;
+				size_t size;
+				std::weak_ptr<BlockRecording> recording;
+				size_t firstString;
+				size_t stringCount;
+			};
+
+			std::vector<PendingBlock> nextGeneration{};
+			std::unordered_multimap<uint64_t, KnownBlock> knownBlocks{};
+			std::vector<std::pair<size_t, const char*>> knownBlockStrings{};
+			// Processing functions of pending blocks. Each generation gets its own arena, which is cleared once it has been stitched.
+			FunctionArena pendingFunctions[2]{};
+			size_t pendingArena{};
+			inline static thread_local BlockRecording* currentRecording{};
+			inline static thread_local size_t dbgStructStartLoc{};
+			inline static thread_local void* currentStructAddr{};
 
 			SerializeChunk(ReflectionSerializer& serializer) : serializer{ serializer }, worker{ serializer.backend.tellp() } {}
 
+			Output out() {
+				return { serializer.backend, currentRecording };
+			}
+
 			template<typename T, typename F>
 			offset_t<T> enqueueBlock(const T* ptr, size_t bufferSize, size_t alignment, F processFunc) {
 				if (ptr == nullptr)
 					return offset_t<T>{};
 
-				auto it = serializer.knownPtrs.find(ptr);
-				if (it != serializer.knownPtrs.end() && bufferSize <= it->second.bufferSize)
-					return it->second.offset;
+				if (currentRecording)
+					return currentRecording->addChildBlock(ptr, bufferSize, alignment, std::move(processFunc));
 
-				size_t offset = worker.enqueueBlock(bufferSize, alignment, [this, bufferSize, processFunc](size_t offset, size_t alignment) {
-					serializer.backend.write_padding(alignment);
-					assert(serializer.backend.tellp() == offset);
+				return allocateBlock(ptr, bufferSize, alignment, std::move(processFunc));
+			}
 
-					processFunc();
+			// Child block functions live in the arena of their parent's recording, which is freed before the child is processed.
+			template<typename F>
+			auto keepFunction(F& processFunc) {
+				if constexpr (std::is_same_v<F, ArenaFunction>)
+					return pendingFunctions[pendingArena].relocate(processFunc);
+				else
+					return std::move(processFunc);
+			}
+
+			template<typename F>
+			ArenaFunction storeFunction(F& processFunc) {
+				if constexpr (std::is_same_v<F, ArenaFunction>)
+					return pendingFunctions[pendingArena].relocate(processFunc);
+				else
+					return pendingFunctions[pendingArena].create(std::move(processFunc));
+			}
+
+			bool matchesKnownBlock(const KnownBlock& known, const BlockRecording& recording) const {
+				size_t size = recording.raw_stream.size();
+
+				if (known.size != size)
+					return false;
+
+				size_t stringIndex = known.firstString;
+				size_t stringEnd = known.firstString + known.stringCount;
+
+				for (auto& event : recording.events) {
+					if (event.type != BlockRecording::Event::Type::STRING)
+						continue;
+
+					if (stringIndex == stringEnd)
+						return false;
+
+					auto [pos, str] = knownBlockStrings[stringIndex++];
+					auto* otherStr = static_cast<const char*>(event.ptr);
 
-					assert(serializer.backend.tellp() == offset + bufferSize);
-				});
-				serializer.knownPtrs[ptr] = { offset, bufferSize };
+					if (pos != event.pos - recording.base || (str == nullptr || otherStr == nullptr ? str != otherStr : strcmp(str, otherStr) != 0))
+						return false;
+				}
+
+				if (stringIndex != stringEnd)
+					return false;
+
+				const char* knownBytes;
+
+				if (auto knownRecording = known.recording.lock())
+					knownBytes = knownRecording->raw_stream.data();
+				else
+					knownBytes = serializer.backend.view_bytes(known.offset, size);
+
+				return knownBytes != nullptr && memcmp(knownBytes, recording.raw_stream.data(), size) == 0;
+			}
+
+			std::optional<size_t> findKnownBlock(uint64_t hash, size_t alignment, const BlockRecording& recording) const {
+				auto [begin, end] = knownBlocks.equal_range(hash);
+
+				for (auto it = begin; it != end; it++)
+					if (it->second.offset % alignment == 0 && matchesKnownBlock(it->second, recording))
+						return it->second.offset;
+
+				return std::nullopt;
+			}
+
+			void addKnownBlock(uint64_t hash, size_t offset, const std::shared_ptr<BlockRecording>& recording) {
+				size_t firstString = knownBlockStrings.size();
+
+				for (auto& event : recording->events)
+					if (event.type == BlockRecording::Event::Type::STRING)
+						knownBlockStrings.emplace_back(event.pos - recording->base, static_cast<const char*>(event.ptr));
+
+				knownBlocks.emplace(hash, KnownBlock{ offset, recording->raw_stream.size(), recording, firstString, knownBlockStrings.size() - firstString });
+			}
+
+			template<typename F>
+			size_t allocateBlock(const void* ptr, size_t bufferSize, size_t alignment, F processFunc, std::shared_ptr<BlockRecording> recording = nullptr) {
+				auto* known = serializer.knownPtrs.find(ptr);
+				if (known != nullptr && bufferSize <= known->bufferSize)
+					return known->offset;
+
+				std::optional<uint64_t> contentHash{};
+				std::shared_ptr<BlockRecording> leafRecording{};
+				size_t recordingAlignment{ 1 };
+
+				if (serializer.deduplicate) {
+					if (!recording) {
+						recording = std::make_shared<BlockRecording>(0);
+						recordBlock(processFunc, bufferSize, *recording);
+					}
+
+					recordingAlignment = std::max(alignment, recording->maxAlignment);
+
+					if (recording->isLeaf()) {
+						contentHash = recording->contentHash();
+
+						if (auto knownOffset = findKnownBlock(contentHash.value(), recordingAlignment, *recording)) {
+							serializer.knownPtrs.insert(ptr, knownOffset.value(), bufferSize);
+							return knownOffset.value();
+						}
+
+						leafRecording = recording;
+					}
+				}
+
+				size_t offset;
+
+				if (serializer.jobs > 1) {
+					offset = worker.allocator.allocate({ bufferSize, alignment });
+
+					if (recording && offset % recordingAlignment != 0)
+						recording = nullptr;
+
+					nextGeneration.push_back({ offset, bufferSize, alignment, storeFunction(processFunc), std::move(recording) });
+				}
+				else if (recording) {
+					offset = worker.enqueueBlock(bufferSize, alignment, [this, bufferSize, processFunc = keepFunction(processFunc), recording = std::move(recording)](size_t offset, size_t alignment) {
+						if (offset % std::max(alignment, recording->maxAlignment) == 0)
+							stitchBlock(offset, alignment, bufferSize, *recording);
+						else {
+							serializer.backend.write_padding(alignment);
+							processFunc();
+						}
+					});
+				}
+				else {
+					offset = worker.enqueueBlock(bufferSize, alignment, [this, bufferSize, processFunc](size_t offset, size_t alignment) {
+						serializer.backend.write_padding(alignment);
+						assert(serializer.backend.tellp() == offset);
+
+						processFunc();
+
+						assert(serializer.backend.tellp() == offset + bufferSize);
+					});
+				}
+
+				if (contentHash.has_value() && offset % recordingAlignment == 0)
+					addKnownBlock(contentHash.value(), offset, leafRecording);
+
+				serializer.knownPtrs.insert(ptr, offset, bufferSize);
 				return offset;
 			}
 
+			std::optional<size_t> resolveBackReference(const void* ptr) {
+				if (auto* known = serializer.knownPtrs.find(ptr))
+					return known->offset;
+				else
+					return serializer.knownPtrs.resolve(ptr);
+			}
+
+			template<typename F>
+			void recordBlock(F& processFunc, size_t bufferSize, BlockRecording& recording) {
+				BlockRecording* prevRecording = currentRecording;
+				size_t prevDbgStructStartLoc = dbgStructStartLoc;
+				void* prevStructAddr = currentStructAddr;
+
+				// The block is unrelated to any struct we might be in the middle of.
+				currentRecording = &recording;
+				dbgStructStartLoc = 0;
+				currentStructAddr = nullptr;
+
+				auto restore = [&]() {
+					currentRecording = prevRecording;
+					dbgStructStartLoc = prevDbgStructStartLoc;
+					currentStructAddr = prevStructAddr;
+				};
+
+				try {
+					processFunc();
+				}
+				catch (...) {
+					restore();
+					throw;
+				}
+
+				restore();
+
+				assert(recording.raw_stream.tellp() == recording.base + bufferSize);
+			}
+
+			void stitchBlock(size_t offset, size_t alignment, size_t bufferSize, BlockRecording& recording) {
+				serializer.backend.write_padding(alignment);
+				assert(serializer.backend.tellp() == offset);
+
+				std::vector<size_t> resolved(recording.events.size());
+				size_t written{};
+
+				auto writeUntil = [&](size_t pos) {
+					serializer.backend.write_bytes(recording.raw_stream.data() + written, pos - recording.base - written);
+					written = pos - recording.base + sizeof(typename Backend::address_type);
+				};
+
+				for (size_t i = 0; i < recording.events.size(); i++) {
+					auto& event = recording.events[i];
+
+					switch (event.type) {
+					case BlockRecording::Event::Type::CHILD_BLOCK: {
+						auto& child = recording.children[event.value];
+						resolved[i] = allocateBlock(child.ptr, child.bufferSize, child.alignment, child.processFunc, std::move(child.recording));
+						break;
+					}
+					case BlockRecording::Event::Type::BACKREFERENCE: {
+						auto offset = resolveBackReference(event.ptr);
+						assert(offset.has_value() && "cannot find backreference");
+						resolved[i] = offset.has_value() ? offset.value() : BlockRecording::nullOffset;
+						break;
+					}
+					case BlockRecording::Event::Type::OFFSET: {
+						size_t value = event.value;
+
+						if (value != BlockRecording::nullOffset && (value & BlockRecording::placeholderTag))
+							value = resolved[value & ~BlockRecording::placeholderTag];
+
+						writeUntil(event.pos);
+						serializer.backend.write(value == BlockRecording::nullOffset ? offset_t<opaque_obj>{} : offset_t<opaque_obj>{ value });
+						break;
+					}
+					case BlockRecording::Event::Type::STRING:
+						if constexpr (Backend::hasNativeStrings) {
+							writeUntil(event.pos);
+							serializer.backend.write(static_cast<const char*>(event.ptr));
+						}
+						break;
+					}
+				}
+
+				if (written < recording.raw_stream.size())
+					serializer.backend.write_bytes(recording.raw_stream.data() + written, recording.raw_stream.size() - written);
+
+				assert(serializer.backend.tellp() == offset + bufferSize);
+			}
+
+			void processGenerations() {
+				while (!nextGeneration.empty()) {
+					std::vector<PendingBlock> generation = std::move(nextGeneration);
+					nextGeneration.clear();
+
+					FunctionArena& generationFunctions = pendingFunctions[pendingArena];
+					pendingArena ^= 1;
+
+					for (size_t batchStart = 0; batchStart < generation.size(); batchStart += recordingBatchSize) {
+						size_t batchSize = std::min(recordingBatchSize, generation.size() - batchStart);
+
+						util::parallel_for(batchSize, [&](size_t i) {
+							auto& block = generation[batchStart + i];
+
+							if (!block.recording) {
+								block.recording = std::make_shared<BlockRecording>(block.offset);
+								recordBlock(block.processFunc, block.bufferSize, *block.recording);
+							}
+
+							// Deduplication needs the contents of the children before they are allocated, so record them here while we're parallel.
+							if (serializer.deduplicate) {
+								for (auto& child : block.recording->children) {
+									child.recording = std::make_shared<BlockRecording>(0);
+									recordBlock(child.processFunc, child.bufferSize, *child.recording);
+								}
+							}
+						}, serializer.jobs);
+
+						for (size_t i = batchStart; i < batchStart + batchSize; i++) {
+							auto& block = generation[i];
+
+							stitchBlock(block.offset, block.alignment, block.bufferSize, *block.recording);
+							block.recording = nullptr;
+						}
+					}
+
+					generation.clear();
+					generationFunctions.clear();
+				}
+			}
+
 			template<typename T, std::enable_if_t<!std::is_fundamental_v<T>, bool> = true>
 			int visit_primitive(T& obj, const PrimitiveInfo<T>& info) {
-				serializer.backend.template write<T>(obj);
+				out().write(obj);
 				return 0;
 			}
 
 			template<typename T, std::enable_if_t<std::is_fundamental_v<T>, bool> = true>
 			int visit_primitive(T& obj, const PrimitiveInfo<T>& info) {
-				serializer.backend.write(info.erased ? T{} : obj);
+				out().write(info.erased ? T{} : obj);
 				return 0;
 			}
 
 			void write_string(const char* obj) {
 				if constexpr (Backend::hasNativeStrings)
-					serializer.backend.write(obj);
+					out().write(obj);
 				else
-					serializer.backend.write(obj == nullptr ? offset_t<char>{} : enqueueBlock(obj, strlen(obj) + 1, 1, [this, obj]() {
-						serializer.backend.write_string(obj);
+					out().write(obj == nullptr ? offset_t<char>{} : enqueueBlock(obj, strlen(obj) + 1, 1, [this, obj]() {
+						out().write_string(obj);
 					}));
 			}
 
@@ -88,24 +633,19 @@ namespace rip::binary {
 
 			int visit_primitive(ucsl::strings::VariableString& obj, const PrimitiveInfo<ucsl::strings::VariableString>& info) {
 				write_string(reinterpret_cast<const char*&>(obj));
-				serializer.backend.write(0ull);
+				out().write(0ull);
 				return 0;
 			}
 
 			int visit_primitive(void*& obj, const PrimitiveInfo<void*>& info) {
 				if (obj == nullptr)
-					serializer.backend.write(offset_t<opaque_obj>{});
-				else if (serializer.knownPtrs.contains(obj))
-					serializer.backend.write(offset_t<opaque_obj>{ serializer.knownPtrs[obj].offset });
-				else {
-					for (auto& item : serializer.knownPtrs) {
-						if (obj >= item.first && obj < addptr(item.first, item.second.bufferSize)) {
-							serializer.backend.write(offset_t<opaque_obj>{ item.second.offset + (reinterpret_cast<size_t>(obj) - reinterpret_cast<size_t>(item.first)) });
-							return 0;
-						}
-					}
+					out().write(offset_t<opaque_obj>{});
+				else if (currentRecording)
+					out().write(offset_t<opaque_obj>{ currentRecording->addBackReference(obj) });
+				else if (auto offset = resolveBackReference(obj))
+					out().write(offset_t<opaque_obj>{ offset.value() });
+				else
 					assert(false && "cannot find backreference");
-				}
 				return 0;
 			}
 
@@ -121,32 +661,34 @@ namespace rip::binary {
 
 			template<typename F, typename C, typename D, typename A>
 			int visit_array(A& arr, const ArrayInfo& info, C c, D d, F f) {
-				serializer.backend.write(enqueueBlock(&arr[0], arr.size() * info.itemSize, info.itemAlignment, [arr, f]() {
-					A myarr{ arr };
-					for (opaque_obj& item : myarr)
-						f(item);
+				auto* buffer = &arr[0];
+
+				out().write(enqueueBlock(buffer, arr.size() * info.itemSize, info.itemAlignment, [buffer, length = arr.size(), itemSize = info.itemSize, f]() {
+					for (size_t i = 0; i < length; i++)
+						f(*addptr(buffer, i * itemSize));
 				}));
-				serializer.backend.write(arr.size());
-				serializer.backend.write(arr.capacity());
-				serializer.backend.write(0ull);
+				out().write(arr.size());
+				out().write(arr.capacity());
+				out().write(0ull);
 				return 0;
 			}
 
 			template<typename F, typename C, typename D, typename A>
 			int visit_tarray(A& arr, const ArrayInfo& info, C c, D d, F f) {
-				serializer.backend.write(enqueueBlock(&arr[0], arr.size() * info.itemSize, info.itemAlignment, [arr, f]() {
-					A myarr{ arr };
-					for (opaque_obj& item : myarr)
-						f(item);
+				auto* buffer = &arr[0];
+
+				out().write(enqueueBlock(buffer, arr.size() * info.itemSize, info.itemAlignment, [buffer, length = arr.size(), itemSize = info.itemSize, f]() {
+					for (size_t i = 0; i < length; i++)
+						f(*addptr(buffer, i * itemSize));
 				}));
-				serializer.backend.write(arr.size());
-				serializer.backend.write(static_cast<int64_t>(arr.capacity()));
+				out().write(arr.size());
+				out().write(static_cast<int64_t>(arr.capacity()));
 				return 0;
 			}
 
 			template<typename F, typename A, typename S>
 			int visit_pointer(opaque_obj*& obj, const PointerInfo<A, S>& info, F f) {
-				serializer.backend.write(enqueueBlock(obj, info.getTargetSize(), info.getTargetAlignment(), [obj, f]() {
+				out().write(enqueueBlock(obj, info.getTargetSize(), info.getTargetAlignment(), [obj, f]() {
 					f(*obj);
 				}));
 				return 0;
@@ -167,21 +709,21 @@ namespace rip::binary {
 
 			template<typename F>
 			int visit_type(opaque_obj& obj, const TypeInfo& info, F f) {
-				serializer.backend.write_padding(info.alignment);
+				out().write_padding(info.alignment);
 
-				size_t typeStart = serializer.backend.tellp();
+				size_t typeStart = out().tellp();
 
 				// Catch alignment issues.
 				if (currentStructAddr)
-					assert((serializer.backend.tellp() - dbgStructStartLoc) == (reinterpret_cast<size_t>(&obj) - reinterpret_cast<size_t>(currentStructAddr)));
+					assert((out().tellp() - dbgStructStartLoc) == (reinterpret_cast<size_t>(&obj) - reinterpret_cast<size_t>(currentStructAddr)));
 
 				f(obj);
 
-				serializer.backend.write_padding_bytes(info.size - (serializer.backend.tellp() - typeStart));
+				out().write_padding_bytes(info.size - (out().tellp() - typeStart));
 
 				// Catch alignment issues.
 				if (currentStructAddr)
-					assert((serializer.backend.tellp() - dbgStructStartLoc) == (reinterpret_cast<size_t>(&obj) + info.size - reinterpret_cast<size_t>(currentStructAddr)));
+					assert((out().tellp() - dbgStructStartLoc) == (reinterpret_cast<size_t>(&obj) + info.size - reinterpret_cast<size_t>(currentStructAddr)));
 				return 0;
 			}
 
@@ -201,7 +743,7 @@ namespace rip::binary {
 				size_t prevDbgStructStartLoc = dbgStructStartLoc;
 				void* prevStructAddr = currentStructAddr;
 
-				dbgStructStartLoc = serializer.backend.tellp();
+				dbgStructStartLoc = out().tellp();
 				currentStructAddr = &obj;
 
 				f(obj);
@@ -214,13 +756,17 @@ namespace rip::binary {
 			template<typename F>
 			int visit_root(opaque_obj& obj, const RootInfo& info, F f) {
 				enqueueBlock(&obj, info.size, info.alignment, [&obj, f]() { f(obj); });
-				worker.processQueuedBlocks();
+
+				if (serializer.jobs > 1)
+					processGenerations();
+				else
+					worker.processQueuedBlocks();
 				return 0;
 			}
 		};
 
 	public:
-		ReflectionSerializer(Backend& backend) : backend{ backend } { }
+		ReflectionSerializer(Backend& backend, SerializerOptions options = {}) : backend{ backend }, jobs{ options.jobs == 0 ? util::get_worker_count() : options.jobs }, deduplicate{ options.deduplicate } { }
 
 		template<typename T, typename R>
 		void serialize(T& data, R refl) {
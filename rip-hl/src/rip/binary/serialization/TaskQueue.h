@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
+#include <rip/util/memory.h>
+
+namespace rip::binary {
+	/*
+	 * Bump allocator over a list of fixed size chunks.
+	 * Resetting it keeps the chunks around, so a warmed up arena no longer touches the heap.
+	 */
+	class TaskArena {
+		struct Chunk {
+			std::unique_ptr<char[]> data;
+			size_t size;
+		};
+
+		std::vector<Chunk> chunks{};
+		size_t chunkSize;
+		size_t currentChunk{};
+		size_t pos{};
+
+	public:
+		TaskArena(size_t chunkSize = 64 * 1024) : chunkSize{ chunkSize } {}
+
+		void* allocate(size_t size, size_t alignment) {
+			while (currentChunk < chunks.size()) {
+				auto& chunk = chunks[currentChunk];
+				size_t start = reinterpret_cast<size_t>(chunk.data.get());
+				size_t addr = align(start + pos, alignment);
+
+				if (addr + size <= start + chunk.size) {
+					pos = addr + size - start;
+					return reinterpret_cast<void*>(addr);
+				}
+
+				currentChunk++;
+				pos = 0;
+			}
+
+			size_t newChunkSize = std::max(chunkSize, size + alignment);
+
+			chunks.push_back(Chunk{ std::make_unique<char[]>(newChunkSize), newChunkSize });
+
+			size_t start = reinterpret_cast<size_t>(chunks.back().data.get());
+			size_t addr = align(start, alignment);
+
+			pos = addr + size - start;
+			return reinterpret_cast<void*>(addr);
+		}
+
+		void reset() {
+			currentChunk = 0;
+			pos = 0;
+		}
+	};
+
+	/*
+	 * FIFO queue of type-erased callables.
+	 * The callables are stored inline in TaskArenas and linked intrusively. The queue is run in batches: a batch is
+	 * everything that is queued when it starts, and tasks pushed while it runs go to the other arena. The memory of a
+	 * batch is reused as soon as it has finished, so the arenas only grow to the size of the two largest consecutive
+	 * batches and pushing a task no longer allocates once they have.
+	 */
+	class TaskQueue {
+		struct Task {
+			Task* next{};
+
+			virtual ~Task() = default;
+			virtual void run() = 0;
+		};
+
+		template<typename F>
+		struct TaskImpl : Task {
+			F func;
+
+			TaskImpl(F&& func) : func{ std::move(func) } {}
+			TaskImpl(const F& func) : func{ func } {}
+
+			virtual void run() override {
+				func();
+			}
+		};
+
+		TaskArena arenas[2]{};
+		size_t pushArena{};
+		Task* head{};
+		Task* tail{};
+
+	public:
+		TaskQueue() = default;
+		TaskQueue(const TaskQueue&) = delete;
+		TaskQueue& operator=(const TaskQueue&) = delete;
+
+		~TaskQueue() {
+			clear();
+		}
+
+		template<typename F>
+		void push(F&& func) {
+			using Impl = TaskImpl<std::decay_t<F>>;
+
+			Task* task = new (arenas[pushArena].allocate(sizeof(Impl), alignof(Impl))) Impl{ std::forward<F>(func) };
+
+			if (tail)
+				tail->next = task;
+			else
+				head = task;
+
+			tail = task;
+		}
+
+		bool empty() const {
+			return head == nullptr;
+		}
+
+		// Runs tasks until the queue is empty, including tasks pushed by the tasks themselves.
+		void run() {
+			while (head) {
+				Task* batchTail = tail;
+				bool batchDone{};
+
+				pushArena ^= 1;
+
+				while (!batchDone) {
+					Task* task = head;
+
+					head = task->next;
+					if (!head)
+						tail = nullptr;
+
+					batchDone = task == batchTail;
+
+					// The task is no longer reachable from head, so it has to be destroyed here even if it throws.
+					struct Destroyer {
+						Task* task;
+
+						~Destroyer() {
+							task->~Task();
+						}
+					} destroyer{ task };
+
+					task->run();
+				}
+
+				// Everything still queued was pushed during the batch and lives in the push arena.
+				arenas[pushArena ^ 1].reset();
+			}
+
+			arenas[pushArena].reset();
+		}
+
+		void clear() {
+			while (head) {
+				Task* task = head;
+
+				head = task->next;
+				task->~Task();
+			}
+
+			tail = nullptr;
+			arenas[0].reset();
+			arenas[1].reset();
+		}
+	};
+
+	class FunctionArena;
+
+	/*
+	 * Copyable handle to a void() callable owned by a FunctionArena.
+	 * Handles don't own the callable, so they must not be invoked after the arena has been cleared or destroyed.
+	 */
+	class ArenaFunction {
+		friend class FunctionArena;
+
+		struct Callable {
+			Callable* next{};
+
+			virtual ~Callable() = default;
+			virtual void run() = 0;
+			virtual Callable* moveTo(FunctionArena& arena) = 0;
+		};
+
+		Callable* callable{};
+
+		ArenaFunction(Callable* callable) : callable{ callable } {}
+
+	public:
+		ArenaFunction() = default;
+
+		void operator()() const {
+			callable->run();
+		}
+	};
+
+	/*
+	 * Stores type-erased callables in a TaskArena and destroys them all at once when cleared.
+	 */
+	class FunctionArena {
+		template<typename F>
+		struct CallableImpl : ArenaFunction::Callable {
+			F func;
+
+			CallableImpl(F&& func) : func{ std::move(func) } {}
+			CallableImpl(const F& func) : func{ func } {}
+
+			virtual void run() override {
+				func();
+			}
+
+			virtual ArenaFunction::Callable* moveTo(FunctionArena& arena) override {
+				return arena.emplace(std::move(func));
+			}
+		};
+
+		TaskArena arena;
+		ArenaFunction::Callable* head{};
+
+		template<typename F>
+		ArenaFunction::Callable* emplace(F&& func) {
+			using Impl = CallableImpl<std::decay_t<F>>;
+
+			ArenaFunction::Callable* callable = new (arena.allocate(sizeof(Impl), alignof(Impl))) Impl{ std::forward<F>(func) };
+
+			callable->next = head;
+			head = callable;
+			return callable;
+		}
+
+	public:
+		FunctionArena(size_t chunkSize = 64 * 1024) : arena{ chunkSize } {}
+		FunctionArena(const FunctionArena&) = delete;
+		FunctionArena& operator=(const FunctionArena&) = delete;
+
+		~FunctionArena() {
+			clear();
+		}
+
+		template<typename F>
+		ArenaFunction create(F&& func) {
+			return emplace(std::forward<F>(func));
+		}
+
+		// Moves the callable behind a handle into this arena, leaving the original in a moved-from state.
+		ArenaFunction relocate(const ArenaFunction& func) {
+			return func.callable->moveTo(*this);
+		}
+
+		void clear() {
+			while (head) {
+				ArenaFunction::Callable* callable = head;
+
+				head = callable->next;
+				callable->~Callable();
+			}
+
+			arena.reset();
+		}
+	};
+}
@@ -1,8 +1,14 @@
 #pragma once
 #include <iostream>
+#include <iterator>
 #include <bit>
 #include <ranges>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <cassert>
 #include <rip/util/memory.h>
 #include <rip/util/byteswap.h>
 #include "types.h"
@@ -12,58 +18,181 @@ namespace rip::binary {
 		inline char zeroes[8192]{};
 	}
 
+	/*
+	 * Reads from a contiguous block of memory.
+	 * Reads are plain bounds-checked memcpys and seeks only move a cursor.
+	 */
 	class fast_istream {
-		std::istream& stream;
-		size_t shadow_pos; // prevent doing slow tellg() calls.
+		std::vector<char> ownedData{}; // only used when constructed from a std::istream.
+		const char* data;
+		size_t size;
+		size_t pos;
+
+		inline void check_bounds(size_t count) const {
+			if (pos > size || count > size - pos)
+				throw std::runtime_error{ "Attempted to read past the end of the input." };
+		}
 
 	public:
-		fast_istream(std::istream& stream) : stream{ stream }, shadow_pos{ (size_t)stream.tellg() } {}
+		fast_istream(const void* data, size_t size) : data{ static_cast<const char*>(data) }, size{ size }, pos{} {}
+
+		// Slurps the stream into memory. For seekable streams positions stay absolute stream positions, streams that
+		// can't seek (pipes) are read from their current position on and positions are relative to that.
+		fast_istream(std::istream& stream) {
+			std::istream::pos_type start = stream.tellg();
+
+			if (start != std::istream::pos_type(-1) && stream.seekg(0, std::ios::end)) {
+				std::istream::pos_type end = stream.tellg();
+
+				if (end == std::istream::pos_type(-1) || !stream.seekg(0))
+					throw std::runtime_error{ "Could not determine the size of the input stream." };
+
+				ownedData.resize(static_cast<size_t>(end));
+
+				if (!stream.read(ownedData.data(), ownedData.size()) || stream.gcount() != static_cast<std::streamsize>(ownedData.size()))
+					throw std::runtime_error{ "Could not read the input stream." };
+
+				pos = static_cast<size_t>(start);
+			}
+			else {
+				stream.clear();
+				ownedData.assign(std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{});
 
-		void read(char* str, size_t count) {
-			stream.read(str, count);
-			shadow_pos += count;
+				if (stream.bad())
+					throw std::runtime_error{ "Could not read the input stream." };
+
+				pos = 0;
+			}
+
+			data = ownedData.data();
+			size = ownedData.size();
+		}
+
+		fast_istream(const fast_istream&) = delete;
+		fast_istream& operator=(const fast_istream&) = delete;
+
+		inline void read(char* str, size_t count) {
+			check_bounds(count);
+			memcpy(str, data + pos, count);
+			pos += count;
 		}
 
 		void read_string(std::string& str) {
-			std::getline(stream, str, '\0');
-			shadow_pos += str.size() + 1;
+			check_bounds(0);
+
+			const char* start = data + pos;
+			const char* end = static_cast<const char*>(memchr(start, '\0', size - pos));
+
+			if (end == nullptr)
+				throw std::runtime_error{ "Unterminated string at the end of the input." };
+
+			str.assign(start, end);
+			pos += str.size() + 1;
 		}
 
-		void seekg(size_t loc) {
-			stream.seekg(loc);
-			shadow_pos = loc;
+		// Returns the NUL-terminated string at loc without copying it or moving the cursor.
+		std::string_view view_string(size_t loc) const {
+			if (loc >= size)
+				throw std::runtime_error{ "Attempted to read past the end of the input." };
+
+			const char* start = data + loc;
+			const char* end = static_cast<const char*>(memchr(start, '\0', size - loc));
+
+			if (end == nullptr)
+				throw std::runtime_error{ "Unterminated string at the end of the input." };
+
+			return { start, static_cast<size_t>(end - start) };
 		}
 
-		size_t tellg() const {
-			return shadow_pos;
+		inline void seekg(size_t loc) {
+			pos = loc;
+		}
+
+		inline size_t tellg() const {
+			return pos;
 		}
 	};
 
+	/*
+	 * Collects all output in memory. Seeking and patching earlier data are plain memory writes,
+	 * and the result goes out to the underlying stream in one write when flushed or destroyed.
+	 */
 	class fast_ostream {
-		std::ostream& stream;
-		size_t shadow_pos; // prevent doing slow tellg() calls.
+		std::ostream* stream;
+		std::vector<char> buffer{};
+		size_t base; // stream position of the start of the buffer.
+		size_t pos;
 
 	public:
-		fast_ostream(std::ostream& stream) : stream{ stream }, shadow_pos{ (size_t)stream.tellp() } {}
+		fast_ostream(std::ostream& stream) : stream{ &stream }, base{ (size_t)stream.tellp() }, pos{ base } {}
+		// In-memory stream whose contents start at position `base`, never flushed anywhere.
+		fast_ostream(size_t base = 0) : stream{}, base{ base }, pos{ base } {}
+		fast_ostream(const fast_ostream&) = delete;
+		fast_ostream& operator=(const fast_ostream&) = delete;
+
+		~fast_ostream() {
+			flush();
+		}
+
+		// Writes at an arbitrary position without moving the cursor. Any gap before it is filled with zeroes.
+		inline void write_at(size_t loc, const char* str, size_t count) {
+			assert(loc >= base && "cannot patch data that has already been flushed");
+
+			if (count == 0)
+				return;
 
-		void write(const char* str, size_t count) {
-			stream.write(str, count);
-			shadow_pos += count;
+			size_t end = loc - base + count;
+
+			if (end > buffer.size())
+				buffer.resize(end);
+
+			memcpy(buffer.data() + (loc - base), str, count);
+		}
+
+		inline void write(const char* str, size_t count) {
+			write_at(pos, str, count);
+			pos += count;
 		}
 
 		void write_string(const char* str) {
-			size_t size = strlen(str) + 1;
-			stream.write(str, size);
-			shadow_pos += size;
+			write(str, strlen(str) + 1);
 		}
 
-		void seekp(size_t loc) {
-			stream.seekp(loc);
-			shadow_pos = loc;
+		inline void seekp(size_t loc) {
+			pos = loc;
 		}
 
-		size_t tellp() const {
-			return shadow_pos;
+		inline size_t tellp() const {
+			return pos;
+		}
+
+		// Unflushed contents, starting at the base position.
+		inline const char* data() const {
+			return buffer.data();
+		}
+
+		inline size_t size() const {
+			return buffer.size();
+		}
+
+		// Unflushed contents at a stream position, or nullptr if they are not in the buffer (anymore).
+		inline const char* view(size_t loc, size_t count) const {
+			if (loc < base || loc - base + count > buffer.size())
+				return nullptr;
+
+			return buffer.data() + (loc - base);
+		}
+
+		void flush() {
+			if (stream == nullptr || buffer.empty())
+				return;
+
+			stream->write(buffer.data(), buffer.size());
+			base += buffer.size();
+			buffer.clear();
+
+			if (pos < base)
+				pos = base;
 		}
 	};
 
@@ -97,6 +226,10 @@ namespace rip::binary {
 			stream.read_string(str);
 		}
 
+		std::string_view view_string(size_t loc) const {
+			return stream.view_string(loc + offset);
+		}
+
 		void skip_padding(size_t alignment) {
 			skip_padding_bytes(align(tellg(), alignment) - tellg());
 		}
@@ -121,6 +254,9 @@ namespace rip::binary {
 		size_t offset;
 
 	public:
+		using address_type = AddrType;
+		static constexpr std::endian byte_order = endianness;
+
 		binary_ostream(fast_ostream& stream, size_t offset = 0) : stream{ stream }, offset{ offset } {}
 
 		template<typename T, bool byteswap = true>
@@ -146,6 +282,17 @@ namespace rip::binary {
 			write(obj.has_value() ? static_cast<AddrType>(obj.value()) : 0);
 		}
 
+		template<typename T, bool byteswap = true>
+		void write_at(size_t loc, const T& obj) {
+			if constexpr (byteswap) {
+				T val = obj;
+				util::byteswap_deep_to_native(endianness, val);
+				stream.write_at(loc + offset, reinterpret_cast<const char*>(&val), sizeof(T));
+			}
+			else
+				stream.write_at(loc + offset, reinterpret_cast<const char*>(&obj), sizeof(T));
+		}
+
 		void write_string(const char* str) {
 			stream.write_string(str);
 		}
@@ -158,6 +305,14 @@ namespace rip::binary {
 			stream.write(internal::zeroes, size);
 		}
 
+		void write_bytes(const void* data, size_t size) {
+			stream.write(static_cast<const char*>(data), size);
+		}
+
+		const char* view_bytes(size_t loc, size_t size) const {
+			return stream.view(loc + offset, size);
+		}
+
 		void seekp(size_t loc) {
 			stream.seekp(loc + offset);
 		}
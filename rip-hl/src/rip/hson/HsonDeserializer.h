@@ -1,174 +1,463 @@
 #pragma once
-#include <rfl.hpp>
-#include <rfl/json.hpp>
-#include <ctime>
 #include <ucsl/resources/object-world/v2.h>
 #include <ucsl/resources/object-world/v3.h>
 #include <ucsl/resources/sobj/v1.h>
 #include <ucsl-reflection/providers/rflclass.h>
+#include <ucsl-reflection/opaque.h>
+#include <rip/binary/serialization/JsonDeserializer.h>
+#include <rip/util/mapped-file.h>
 #include <rip/util/math.h>
+#include <rip/util/memory.h>
 #include <rip/util/object-id-guids.h>
-#include <random>
-#include "./JsonReflections.h"
+#include <yyjson.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace rip::hson {
-	inline void readHSON(const std::string& filename, auto getObjects) {
-		std::time_t now = std::time(nullptr);
-		std::string date = std::asctime(std::localtime(&now));
+	/*
+	 * Reads an HSON file into object world data, for conversion to a gedit file, or into set object data, for
+	 * conversion to a sobj file.
+	 *
+	 * The file is parsed in situ once, after which the objects are converted one by one: class and component
+	 * RflClasses are looked up once per type, and parameters are deserialized from the parsed values straight
+	 * into their final allocation. Instances take their type and parameters from the object they are an instance
+	 * of, with their own parameters merged on top. Excluded objects are skipped.
+	 *
+	 * All allocated data is owned by the deserializer and freed when it is destroyed.
+	 */
+	template<typename GameInterface, typename Data>
+	class HsonDeserializer {
+		static constexpr bool isSetObjectData = std::is_same_v<Data, ucsl::resources::sobj::v1::SetObjectData<typename GameInterface::AllocatorSystem>>;
+
+		using ObjectData = std::remove_pointer_t<std::remove_reference_t<decltype(std::declval<Data&>().objects[0])>>;
+		using RflClass = typename GameInterface::RflSystem::RflClass;
+		using ObjectsById = std::unordered_map<std::string_view, yyjson_val*>;
+
+		struct DocDeleter {
+			void operator()(yyjson_doc* doc) const {
+				yyjson_doc_free(doc);
+			}
+		};
+
+		struct ClassInfo {
+			const char* name;
+			const RflClass* rflClass;
+		};
+
+		struct Transform {
+			Eigen::Vector3f position;
+			Eigen::Quaternionf rotation;
+		};
+
+		// The values an object is read from. The type comes from the object at the end of its instanceOf chain,
+		// the parameters are those of that object with the parameters of every instance in the chain merged on top.
+		struct ObjectSource {
+			yyjson_val* val;
+			yyjson_val* base;
+			yyjson_val* parameters;
+			std::unique_ptr<yyjson_doc, DocDeleter> mergedParameters{};
+		};
+
+		struct ObjectEntry {
+			ObjectData* object;
+			Transform local;
+			Transform world{};
+			std::string parentId;
+			bool resolving{};
+			bool resolved{};
+		};
+
+		const char* filename;
+		util::mapped_file file{};
+		std::vector<void*> allocations{};
+		std::unordered_map<std::string_view, ClassInfo> objectClasses{};
+		std::unordered_map<std::string_view, ClassInfo> componentClasses{};
+
+		void* allocate(size_t size, size_t alignment) {
+			void* mem = GameInterface::AllocatorSystem::get_allocator()->Alloc(size, alignment);
+			memset(mem, 0, size);
+			allocations.push_back(mem);
+			return mem;
+		}
+
+		template<typename T>
+		T* allocate(size_t count = 1) {
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		const char* copyString(std::string_view str) {
+			char* copy = allocate<char>(str.size() + 1);
+			memcpy(copy, str.data(), str.size());
+			return copy;
+		}
+
+		// Same layout as the arrays filled in by JsonDeserializer. The allocator is left null.
+		template<typename A, typename T>
+		static void setArray(A& arr, T* items, size_t count) {
+			*(T**)addptr(&arr, 0x0) = items;
+			*(unsigned long long*)addptr(&arr, 0x8) = count;
+			*(unsigned long long*)addptr(&arr, 0x10) = count;
+		}
+
+		static std::string_view getString(yyjson_val* val) {
+			return yyjson_is_str(val) ? std::string_view{ yyjson_get_str(val), yyjson_get_len(val) } : std::string_view{};
+		}
+
+		static float getFloat(yyjson_val* arr, size_t index) {
+			return static_cast<float>(yyjson_get_num(yyjson_arr_get(arr, index)));
+		}
+
+		static Eigen::Vector3f getPosition(yyjson_val* val) {
+			if (!yyjson_is_arr(val))
+				return Eigen::Vector3f::Zero();
+
+			return Eigen::Vector3f{ getFloat(val, 0), getFloat(val, 1), getFloat(val, 2) };
+		}
+
+		// HSON stores quaternions as x, y, z, w.
+		static Eigen::Quaternionf getRotation(yyjson_val* val) {
+			if (!yyjson_is_arr(val))
+				return Eigen::Quaternionf::Identity();
+
+			return Eigen::Quaternionf{ getFloat(val, 3), getFloat(val, 0), getFloat(val, 1), getFloat(val, 2) };
+		}
+
+		static void setTransform(auto& transform, const Transform& value) {
+			auto rotation = util::quatToEuler(value.rotation);
+
+			transform.position.x() = value.position.x();
+			transform.position.y() = value.position.y();
+			transform.position.z() = value.position.z();
+			transform.rotation.x() = rotation.x();
+			transform.rotation.y() = rotation.y();
+			transform.rotation.z() = rotation.z();
+		}
+
+		const ClassInfo& getObjectClass(std::string_view type) {
+			auto it = objectClasses.find(type);
+			if (it != objectClasses.end())
+				return it->second;
+
+			std::string name{ type };
+			auto* gameObjectClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(name.c_str());
+			if (gameObjectClass == nullptr)
+				throw std::runtime_error{ "Unknown object type in HSON file: " + name };
+
+			return objectClasses[type] = { copyString(type), gameObjectClass->GetSpawnerDataClass() };
+		}
+
+		const ClassInfo& getComponentClass(std::string_view type) {
+			auto it = componentClasses.find(type);
+			if (it != componentClasses.end())
+				return it->second;
+
+			std::string name{ type };
+			auto* componentInfo = GameInterface::GameObjectSystem::GetInstance()->goComponentRegistry->GetComponentInformationByName(name.c_str());
+			if (componentInfo == nullptr)
+				throw std::runtime_error{ "Unknown component type in HSON file: " + name };
+
+			return componentClasses[type] = { copyString(type), componentInfo->GetSpawnerDataClass() };
+		}
+
+		void* readParameters(yyjson_val* val, const RflClass* rflClass) {
+			rip::binary::JsonDeserializer<GameInterface, true> deserializer{};
+
+			void* parameters = deserializer.template deserialize<opaque_obj>(val, ucsl::reflection::providers::rflclass<GameInterface>::reflect(rflClass));
+			allocations.push_back(parameters);
+			return parameters;
+		}
+
+		void readComponents(ObjectData& object, yyjson_val* tags) {
+			using ComponentData = std::remove_pointer_t<std::remove_reference_t<decltype(object.componentData[0])>>;
+
+			size_t count = yyjson_obj_size(tags);
+
+			if (count == 0)
+				return;
+
+			ComponentData** components = allocate<ComponentData*>(count);
+			size_t i, max;
+			yyjson_val* key;
+			yyjson_val* val;
+			yyjson_obj_foreach(tags, i, max, key, val) {
+				auto& componentClass = getComponentClass(getString(key));
+				ComponentData* component = allocate<ComponentData>();
+
+				component->type = componentClass.name;
+				component->size = componentClass.rflClass->GetSize();
+				component->data = readParameters(val, componentClass.rflClass);
+				components[i] = component;
+			}
 
-		auto file = rfl::json::load<json_reflections::File>(filename);
-	}
+			setArray(object.componentData, components, count);
+		}
 
-	// This is temporary. Cleaner would be to instead make a ReflectCppSerializer that generates an rfl::Generic, so that we can export to many formats.
-	template<typename GameInterface>
-	inline rfl::Object<rfl::Generic> getRflClassSerialization(void* obj, const typename GameInterface::RflSystem::RflClass* rflClass) {
-		yyjson_mut_doc* doc = yyjson_mut_doc_new(nullptr);
+		ObjectSource getSource(yyjson_val* val, const ObjectsById& objectsById) {
+			std::vector<yyjson_val*> chain{ val };
 
-		rip::binary::JsonSerializer serializer{ doc };
-		yyjson_mut_val* json = serializer.serialize(obj, ucsl::reflection::providers::rflclass<GameInterface>::reflect(rflClass));
+			while (yyjson_val* instanceOf = yyjson_obj_get(chain.back(), "instanceOf")) {
+				auto it = objectsById.find(getString(instanceOf));
+				if (it == objectsById.end())
+					throw std::runtime_error{ "HSON object " + std::string{ getString(yyjson_obj_get(val, "id")) } + " is an instance of unknown object " + std::string{ getString(instanceOf) } };
 
-		yyjson_mut_doc_set_root(doc, json);
+				if (chain.size() > objectsById.size())
+					throw std::runtime_error{ "HSON object " + std::string{ getString(yyjson_obj_get(val, "id")) } + " is part of an instanceOf cycle" };
 
-		yyjson_doc* idoc = yyjson_mut_doc_imut_copy(doc, nullptr);
-		yyjson_val* iroot = yyjson_doc_get_root(idoc);
+				chain.push_back(it->second);
+			}
 
-		auto result = rfl::json::read<rfl::Object<rfl::Generic>>(iroot);
+			ObjectSource source{ val, chain.back(), yyjson_obj_get(chain.back(), "parameters") };
 
-		yyjson_doc_free(idoc);
-		yyjson_mut_doc_free(doc);
+			if (std::none_of(chain.begin(), chain.end() - 1, [](yyjson_val* instance) { return yyjson_obj_get(instance, "parameters") != nullptr; }))
+				return source;
 
-		return result.value();
-	}
+			yyjson_mut_doc* doc = yyjson_mut_doc_new(nullptr);
+			yyjson_mut_val* parameters = yyjson_val_mut_copy(doc, source.parameters);
 
-	template<typename GameInterface>
-	inline void serialize(const std::string& filename, ucsl::resources::object_world::v2::ObjectWorldData<typename GameInterface::AllocatorSystem>& data) {
-		writeHSON(filename, [&data]() {
-			auto transformedObjects = std::views::all(data.objects) | std::views::transform([](auto* obj) {
-				auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(obj->gameObjectClass)->GetSpawnerDataClass();
+			for (size_t i = chain.size() - 1; i-- > 0;)
+				if (yyjson_val* overrides = yyjson_obj_get(chain[i], "parameters"))
+					parameters = yyjson_mut_merge_patch(doc, parameters, yyjson_val_mut_copy(doc, overrides));
 
-				rfl::Object<rfl::Generic> tags{};
+			yyjson_mut_doc_set_root(doc, parameters);
+			source.mergedParameters.reset(yyjson_mut_doc_imut_copy(doc, nullptr));
+			yyjson_mut_doc_free(doc);
 
-				for (auto* componentData : obj->componentData) {
-					auto* componentRflClass = GameInterface::GameObjectSystem::GetInstance()->goComponentRegistry->GetComponentInformationByName(obj->gameObjectClass)->GetSpawnerDataClass();
+			if (!source.mergedParameters)
+				throw std::runtime_error{ "Failed to merge the parameters of HSON instance " + std::string{ getString(yyjson_obj_get(val, "id")) } };
 
-					tags[componentData->type] = getRflClassSerialization<GameInterface>(componentData->data, componentRflClass);
-				}
+			source.parameters = yyjson_doc_get_root(source.mergedParameters.get());
+			return source;
+		}
 
-				auto rotation = eulerToQuat(obj->localTransform.rotation);
-
-				return json_reflections::Object{
-					.id = util::toGUID(obj->id),
-					.name = std::string{ obj->name },
-					.parentId = obj->id.id != 0 ? std::make_optional(util::toGUID(obj->parentID)) : std::nullopt,
-					.type = std::string{ obj->gameObjectClass },
-					.position = std::array<float, 3>{ obj->localTransform.position.x(), obj->localTransform.position.y(), obj->localTransform.position.z() },
-					.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-					.parameters = json_reflections::Parameters{
-						.tags = tags,
-						.parameters = getRflClassSerialization<GameInterface>(obj->spawnerData, rflClass),
-					},
-				};
-			});
-
-			return std::vector<json_reflections::Object>{ transformedObjects.begin(), transformedObjects.end() };
-		});
-	}
-
-	template<typename GameInterface>
-	inline void serialize(const std::string& filename, ucsl::resources::object_world::v3::ObjectWorldData<typename GameInterface::AllocatorSystem>& data) {
-		writeHSON(filename, [&data]() {
-			auto transformedObjects = std::views::all(data.objects) | std::views::transform([](auto* obj) {
-				auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(obj->gameObjectClass)->GetSpawnerDataClass();
-
-				rfl::Object<rfl::Generic> tags{};
-
-				for (auto* componentData : obj->componentData) {
-					auto* componentRflClass = GameInterface::GameObjectSystem::GetInstance()->goComponentRegistry->GetComponentInformationByName(obj->gameObjectClass)->GetSpawnerDataClass();
-
-					tags[componentData->type] = getRflClassSerialization<GameInterface>(componentData->data, componentRflClass);
-				}
+		ObjectEntry readObject(const ObjectSource& source) {
+			yyjson_val* val = source.val;
+			auto& objectClass = getObjectClass(getString(yyjson_obj_get(source.base, "type")));
+			yyjson_val* parameters = source.parameters;
+			ObjectData* object = allocate<ObjectData>();
+
+			object->gameObjectClass = objectClass.name;
+			object->name = copyString(getString(yyjson_obj_get(val, "name")));
+			util::fromGUID(object->id, yyjson_get_str(yyjson_obj_get(val, "id")));
+
+			if (const char* parentId = yyjson_get_str(yyjson_obj_get(val, "parentId")))
+				util::fromGUID(object->parentID, parentId);
+
+			readComponents(*object, yyjson_obj_get(parameters, "tags"));
+
+			// The parameters are stored next to the tags, which the field lookup simply skips.
+			object->spawnerData = readParameters(parameters, objectClass.rflClass);
+
+			return {
+				.object = object,
+				.local = { getPosition(yyjson_obj_get(val, "position")), getRotation(yyjson_obj_get(val, "rotation")) },
+				.parentId = yyjson_obj_get(val, "parentId") != nullptr ? util::toGUID(object->parentID) : std::string{},
+			};
+		}
+
+		// HSON transforms of child objects are relative to their parent, gedit files also store the absolute transform.
+		// Parents that are missing from the file or that are part of a cycle are treated as the origin.
+		const Transform& resolveTransform(std::vector<ObjectEntry>& entries, const std::unordered_map<std::string, size_t>& indexById, ObjectEntry& entry) {
+			if (entry.resolved)
+				return entry.world;
+
+			entry.world = entry.local;
+
+			auto parent = entry.parentId.empty() ? indexById.end() : indexById.find(entry.parentId);
 
-				auto rotation = eulerToQuat(obj->localTransform.rotation);
-
-				return json_reflections::Object{
-					.id = util::toGUID(obj->id),
-					.name = std::string{ obj->name },
-					.parentId = obj->parentID.groupId != 0 || obj->parentID.objectId != 0 ? std::make_optional(util::toGUID(obj->parentID)) : std::nullopt,
-					.type = std::string{ obj->gameObjectClass },
-					.position = std::array<float, 3>{ obj->localTransform.position.x(), obj->localTransform.position.y(), obj->localTransform.position.z() },
-					.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-					.parameters = json_reflections::Parameters{
-						.tags = tags,
-						.parameters = getRflClassSerialization<GameInterface>(obj->spawnerData, rflClass),
-					},
-				};
-			});
-
-			return std::vector<json_reflections::Object>{ transformedObjects.begin(), transformedObjects.end() };
-		});
-	}
-
-	template<typename GameInterface>
-	inline void serialize(const std::string& filename, ucsl::resources::sobj::v1::SetObjectData<typename GameInterface::AllocatorSystem>& data) {
-		writeHSON(filename, [&data]() {
-			std::vector<json_reflections::Object> result{};
-			std::mt19937 mt{ std::random_device{}() };
-
-			for (auto& type : std::span{ data.objectTypes, data.objectTypeCount }) {
-				auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(type.name)->GetSpawnerDataClass();
-
-				for (auto idx : std::span{ type.objectIndices, type.objectIndexCount }) {
-					auto* obj = data.objects[idx];
-					auto id = util::toGUID(ucsl::objectids::ObjectIdV1{ obj->id.id & 0x0000FFFF });
-
-					rfl::Object<rfl::Generic> rangeSpawning{};
-					rangeSpawning["rangeIn"] = obj->m_distance;
-					rangeSpawning["rangeOut"] = obj->m_range;
-
-					rfl::Object<rfl::Generic> tags{};
-					tags["RangeSpawning"] = rangeSpawning;
-
-					if (obj->instances.size() > 1) {
-						result.push_back({
-							.id = id,
-							.type = std::string{ type.name },
-							.isExcluded = true,
-							.parameters = json_reflections::Parameters{
-								.tags = tags,
-								.parameters = getRflClassSerialization<GameInterface>(&obj[1], rflClass),
-							},
-						});
-
-						for (auto& instance : obj->instances) {
-							auto rotation = eulerToQuat(instance.rotation);
-
-							result.push_back({
-								.id = util::toGUID(ucsl::objectids::ObjectIdV1{ mt() }),
-								.instanceOf = id,
-								.position = std::array<float, 3>{ instance.position.x(), instance.position.y(), instance.position.z() },
-								.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-							});
-						}
-					}
-					else {
-						auto& instance = obj->instances[0];
-						auto rotation = eulerToQuat(instance.rotation);
-
-						result.push_back({
-							.id = id,
-							.type = std::string{ type.name },
-							.position = std::array<float, 3>{ instance.position.x(), instance.position.y(), instance.position.z() },
-							.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-							.parameters = json_reflections::Parameters{
-								.tags = tags,
-								.parameters = getRflClassSerialization<GameInterface>(&obj[1], rflClass),
-							},
-						});
-					}
+			if (parent != indexById.end() && !entries[parent->second].resolving) {
+				entry.resolving = true;
+				const Transform& parentWorld = resolveTransform(entries, indexById, entries[parent->second]);
+				entry.resolving = false;
+
+				entry.world.position = parentWorld.position + parentWorld.rotation * entry.local.position;
+				entry.world.rotation = parentWorld.rotation * entry.local.rotation;
+			}
+
+			setTransform(entry.object->transform, entry.world);
+			setTransform(entry.object->localTransform, entry.local);
+			entry.resolved = true;
+
+			return entry.world;
+		}
+
+		Data* readObjectWorld(yyjson_val* objects, const ObjectsById& objectsById) {
+			std::vector<ObjectEntry> entries{};
+			std::unordered_map<std::string, size_t> indexById{};
+
+			entries.reserve(yyjson_arr_size(objects));
+
+			size_t i, max;
+			yyjson_val* val;
+			yyjson_arr_foreach(objects, i, max, val) {
+				if (yyjson_get_bool(yyjson_obj_get(val, "isExcluded")))
+					continue;
+
+				entries.push_back(readObject(getSource(val, objectsById)));
+				indexById.try_emplace(util::toGUID(entries.back().object->id), entries.size() - 1);
+			}
+
+			for (auto& entry : entries)
+				resolveTransform(entries, indexById, entry);
+
+			ObjectData** objectData = allocate<ObjectData*>(entries.size());
+			for (size_t i = 0; i < entries.size(); i++)
+				objectData[i] = entries[i].object;
+
+			Data* data = allocate<Data>();
+			setArray(data->objects, objectData, entries.size());
+			return data;
+		}
+
+		// sobj files store instances as extra transforms of a single object, so instances that don't override any
+		// parameters are grouped with the object they are an instance of. Parent transforms are not applied.
+		Data* readSetObjectData(yyjson_val* objects, const ObjectsById& objectsById) {
+			using ObjectTypeData = std::remove_pointer_t<decltype(std::declval<Data&>().objectTypes)>;
+			using ObjectIndex = std::remove_pointer_t<decltype(std::declval<ObjectTypeData&>().objectIndices)>;
+			using Instance = std::remove_cvref_t<decltype(std::declval<ObjectData&>().instances[0])>;
+
+			struct SetObject {
+				ObjectSource source;
+				std::vector<Transform> instances{};
+			};
+
+			struct SetObjectType {
+				const char* name;
+				std::vector<size_t> objectIndices{};
+			};
+
+			std::vector<SetObject> setObjects{};
+			std::unordered_map<yyjson_val*, size_t> indexByBase{};
+
+			size_t i, max;
+			yyjson_val* val;
+			yyjson_arr_foreach(objects, i, max, val) {
+				if (yyjson_get_bool(yyjson_obj_get(val, "isExcluded")))
+					continue;
+
+				ObjectSource source = getSource(val, objectsById);
+				Transform transform{ getPosition(yyjson_obj_get(val, "position")), getRotation(yyjson_obj_get(val, "rotation")) };
+
+				if (source.mergedParameters) {
+					setObjects.push_back({ std::move(source), { transform } });
+					continue;
 				}
+
+				auto [it, inserted] = indexByBase.try_emplace(source.base, setObjects.size());
+				if (inserted)
+					setObjects.push_back({ std::move(source) });
+
+				setObjects[it->second].instances.push_back(transform);
+			}
+
+			ObjectData** objectData = allocate<ObjectData*>(setObjects.size());
+			std::vector<SetObjectType> types{};
+			// Keyed by type name: different object types can share the same spawner data RflClass.
+			std::unordered_map<std::string_view, size_t> typeIndices{};
+
+			for (size_t i = 0; i < setObjects.size(); i++) {
+				auto& setObject = setObjects[i];
+				yyjson_val* idSource = setObject.source.mergedParameters ? setObject.source.val : setObject.source.base;
+				yyjson_val* rangeSpawning = yyjson_obj_get(yyjson_obj_get(setObject.source.parameters, "tags"), "RangeSpawning");
+				auto& objectClass = getObjectClass(getString(yyjson_obj_get(setObject.source.base, "type")));
+				size_t parametersSize = objectClass.rflClass->GetSize();
+
+				// The parameters are stored right after the object.
+				ObjectData* object = static_cast<ObjectData*>(allocate(sizeof(ObjectData) + parametersSize, std::max(alignof(ObjectData), static_cast<size_t>(objectClass.rflClass->GetAlignment()))));
+				Instance* instances = allocate<Instance>(setObject.instances.size());
+
+				util::fromGUID(object->id, yyjson_get_str(yyjson_obj_get(idSource, "id")));
+				object->m_distance = static_cast<float>(yyjson_get_num(yyjson_obj_get(rangeSpawning, "rangeIn")));
+				object->m_range = static_cast<float>(yyjson_get_num(yyjson_obj_get(rangeSpawning, "rangeOut")));
+
+				for (size_t j = 0; j < setObject.instances.size(); j++)
+					setTransform(instances[j], setObject.instances[j]);
+
+				object->instances = { instances, setObject.instances.size() };
+
+				memcpy(&object[1], readParameters(setObject.source.parameters, objectClass.rflClass), parametersSize);
+
+				auto [it, inserted] = typeIndices.try_emplace(objectClass.name, types.size());
+				if (inserted)
+					types.push_back({ objectClass.name });
+
+				types[it->second].objectIndices.push_back(i);
+				objectData[i] = object;
+			}
+
+			ObjectTypeData* objectTypes = allocate<ObjectTypeData>(types.size());
+
+			for (size_t i = 0; i < types.size(); i++) {
+				ObjectIndex* objectIndices = allocate<ObjectIndex>(types[i].objectIndices.size());
+
+				for (size_t j = 0; j < types[i].objectIndices.size(); j++)
+					objectIndices[j] = static_cast<ObjectIndex>(types[i].objectIndices[j]);
+
+				objectTypes[i].name = types[i].name;
+				objectTypes[i].objectIndices = objectIndices;
+				objectTypes[i].objectIndexCount = static_cast<decltype(objectTypes[i].objectIndexCount)>(types[i].objectIndices.size());
+			}
+
+			Data* data = allocate<Data>();
+			data->objectTypes = objectTypes;
+			data->objectTypeCount = static_cast<decltype(data->objectTypeCount)>(types.size());
+			data->objects = objectData;
+			data->objectCount = static_cast<decltype(data->objectCount)>(setObjects.size());
+			return data;
+		}
+
+	public:
+		HsonDeserializer(const char* filename) : filename{ filename } {}
+
+		HsonDeserializer(const HsonDeserializer&) = delete;
+		HsonDeserializer& operator=(const HsonDeserializer&) = delete;
+
+		~HsonDeserializer() {
+			for (void* allocation : allocations)
+				GameInterface::AllocatorSystem::get_allocator()->Free(allocation);
+		}
+
+		Data* deserialize() {
+			file = util::mapped_file{ filename, YYJSON_PADDING_SIZE };
+
+			yyjson_read_err err;
+			yyjson_doc* doc = yyjson_read_opts(static_cast<char*>(file.data()), file.size(), YYJSON_READ_INSITU, nullptr, &err);
+			if (err.code != YYJSON_READ_SUCCESS)
+				throw std::runtime_error{ std::string{ "Error reading HSON: " } + err.msg };
+
+			Data* data;
+
+			try {
+				yyjson_val* objects = yyjson_obj_get(yyjson_doc_get_root(doc), "objects");
+				ObjectsById objectsById{};
+
+				size_t i, max;
+				yyjson_val* val;
+				yyjson_arr_foreach(objects, i, max, val)
+					objectsById.try_emplace(getString(yyjson_obj_get(val, "id")), val);
+
+				if constexpr (isSetObjectData)
+					data = readSetObjectData(objects, objectsById);
+				else
+					data = readObjectWorld(objects, objectsById);
+			}
+			catch (...) {
+				yyjson_doc_free(doc);
+				objectClasses.clear();
+				componentClasses.clear();
+				throw;
 			}
 
-			return result;
-		});
-	}
-}
\ No newline at end of file
+			yyjson_doc_free(doc);
+			objectClasses.clear();
+			componentClasses.clear();
+			return data;
+		}
+	};
+}
@@ -1,187 +1,254 @@
 #pragma once
-#include <rfl.hpp>
-#include <rfl/json.hpp>
 #include <ctime>
+#include <fstream>
 #include <ucsl/resources/object-world/v2.h>
 #include <ucsl/resources/object-world/v3.h>
 #include <ucsl/resources/sobj/v1.h>
 #include <ucsl-reflection/providers/rflclass.h>
+#include <rip/binary/serialization/JsonStreamSerializer.h>
+#include <rip/util/json-writer.h>
 #include <rip/util/math.h>
 #include <rip/util/object-id-guids.h>
+#include <rip/util/parallel.h>
+#include <algorithm>
 #include <random>
-#include "./JsonReflections.h"
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace rip::hson {
-	inline void writeHSON(const std::string& filename, auto getObjects) {
+	/*
+	 * HSON output is written straight to the file: object parameters go from the rflclass traversal into the same
+	 * json_writer as the rest of the document, without an intermediate document per object.
+	 */
+	inline void writeHSON(const std::string& filename, auto writeObjects) {
 		std::time_t now = std::time(nullptr);
 		std::string date = std::asctime(std::localtime(&now));
 
-		rfl::json::save(filename, json_reflections::File{
-			.schema = "https://raw.githubusercontent.com/hedge-dev/hson-schema/main/hson.schema.json",
-			.version = 1,
-			.metadata = json_reflections::Metadata{
-				.name = filename,
-				.author = "Restoration Issue Pocketknife",
-				.date = date.substr(0, date.size() - 1),
-				.version = "1.0.0",
-				.description = "Converted by Restoration Issue Pocketknife.",
-			},
-			.objects = getObjects(),
-		}, YYJSON_WRITE_PRETTY_TWO_SPACES | YYJSON_WRITE_ALLOW_INF_AND_NAN | YYJSON_WRITE_ALLOW_INVALID_UNICODE);
+		std::ofstream ofs{ filename, std::ios::binary };
+		util::json_writer writer{ ofs, YYJSON_WRITE_PRETTY_TWO_SPACES | YYJSON_WRITE_ALLOW_INF_AND_NAN | YYJSON_WRITE_ALLOW_INVALID_UNICODE };
+
+		writer.begin_object();
+		writer.key("$schema");
+		writer.string("https://raw.githubusercontent.com/hedge-dev/hson-schema/main/hson.schema.json");
+		writer.key("version");
+		writer.uint(1);
+		writer.key("metadata");
+		writer.begin_object();
+		writer.key("name");
+		writer.string(filename.c_str(), filename.size());
+		writer.key("author");
+		writer.string("Restoration Issue Pocketknife");
+		writer.key("date");
+		writer.string(date.c_str(), date.size() - 1);
+		writer.key("version");
+		writer.string("1.0.0");
+		writer.key("description");
+		writer.string("Converted by Restoration Issue Pocketknife.");
+		writer.end_object();
+		writer.key("objects");
+		writer.begin_array();
+		writeObjects(writer);
+		writer.end_array();
+		writer.end_object();
 	}
 
-	// This is temporary. Cleaner would be to instead make a ReflectCppSerializer that generates an rfl::Generic, so that we can export to many formats.
-	template<typename GameInterface>
-	inline rfl::Object<rfl::Generic> getRflClassSerialization(void* obj, const typename GameInterface::RflSystem::RflClass* rflClass) {
-		yyjson_mut_doc* doc = yyjson_mut_doc_new(nullptr);
+	/*
+	 * Calls writeItem(writer, i) for every i in [0, count) to write items to the array that is currently open.
+	 * With more than one job, runs of items are written to fragments on worker threads and appended in order,
+	 * which gives the same output as writing them serially.
+	 */
+	inline void writeArrayItems(util::json_writer& writer, size_t count, unsigned int jobs, auto writeItem) {
+		constexpr size_t itemsPerFragment = 64;
+
+		if (jobs == 0)
+			jobs = util::get_worker_count();
 
-		rip::binary::JsonSerializer<true> serializer{ doc };
-		yyjson_mut_val* json = serializer.serialize(obj, ucsl::reflection::providers::rflclass<GameInterface>::reflect(rflClass));
+		if (jobs <= 1 || count <= itemsPerFragment) {
+			for (size_t i = 0; i < count; i++)
+				writeItem(writer, i);
+			return;
+		}
 
-		yyjson_mut_doc_set_root(doc, json);
+		std::vector<std::string> fragments((count + itemsPerFragment - 1) / itemsPerFragment);
 
-		yyjson_doc* idoc = yyjson_mut_doc_imut_copy(doc, nullptr);
-		yyjson_val* iroot = yyjson_doc_get_root(idoc);
+		util::parallel_for(fragments.size(), [&](size_t fragment) {
+			std::ostringstream oss{};
 
-		auto result = rfl::json::read<rfl::Object<rfl::Generic>>(iroot);
+			{
+				util::json_writer fragmentWriter{ oss, writer.get_flags(), writer.depth() };
 
-		yyjson_doc_free(idoc);
-		yyjson_mut_doc_free(doc);
+				for (size_t i = fragment * itemsPerFragment; i < std::min(count, (fragment + 1) * itemsPerFragment); i++)
+					writeItem(fragmentWriter, i);
+			}
 
-		return result.value();
+			fragments[fragment] = std::move(oss).str();
+		}, jobs);
+
+		for (auto& fragment : fragments)
+			writer.append_items(fragment);
 	}
 
-	template<typename GameInterface>
-	inline void serialize(const std::string& filename, ucsl::resources::object_world::v2::ObjectWorldData<typename GameInterface::AllocatorSystem>& data) {
-		writeHSON(filename, [&data]() {
-			auto transformedObjects = std::views::all(data.objects) | std::views::transform([](auto* obj) {
-				auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(obj->gameObjectClass)->GetSpawnerDataClass();
+	inline void writeString(util::json_writer& writer, const char* key, const std::string& value) {
+		writer.key(key);
+		writer.string(value.c_str(), value.size());
+	}
 
-				rfl::Object<rfl::Generic> tags{};
-				
-				for (auto* componentData : obj->componentData) {
-					auto* componentRflClass = GameInterface::GameObjectSystem::GetInstance()->goComponentRegistry->GetComponentInformationByName(componentData->type)->GetSpawnerDataClass();
+	template<typename T>
+	inline void writeGUID(util::json_writer& writer, const char* key, const T& id) {
+		char guid[39];
+		util::toGUID(id, guid);
+		writer.key(key);
+		writer.string(guid);
+	}
 
-					tags[componentData->type] = getRflClassSerialization<GameInterface>(componentData->data, componentRflClass);
-				}
+	inline void writeFloats(util::json_writer& writer, const char* key, std::initializer_list<float> values) {
+		writer.key(key);
+		writer.begin_array();
+		for (float value : values)
+			writer.fp32(value);
+		writer.end_array();
+	}
 
-				auto position = obj->parentID.id != 0 ? obj->localTransform.position : obj->transform.position;
-				auto rotation = util::eulerToQuat(obj->parentID.id != 0 ? obj->localTransform.rotation : obj->transform.rotation);
-
-				return json_reflections::Object{
-					.id = util::toGUID(obj->id),
-					.name = std::string{ obj->name },
-					.parentId = obj->parentID.id != 0 ? std::make_optional(util::toGUID(obj->parentID)) : std::nullopt,
-					.type = std::string{ obj->gameObjectClass },
-					.position = std::array<float, 3>{ position.x(), position.y(), position.z() },
-					.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-					.parameters = json_reflections::Parameters{
-						.tags = tags,
-						.parameters = getRflClassSerialization<GameInterface>(obj->spawnerData, rflClass),
-					},
-				};
-			});
+	inline void writeTransform(util::json_writer& writer, const auto& position, const auto& eulerRotation) {
+		auto rotation = util::eulerToQuat(eulerRotation);
 
-			return std::vector<json_reflections::Object>{ transformedObjects.begin(), transformedObjects.end() };
-		});
+		writeFloats(writer, "position", { position.x(), position.y(), position.z() });
+		writeFloats(writer, "rotation", { rotation.x(), rotation.y(), rotation.z(), rotation.w() });
 	}
 
 	template<typename GameInterface>
-	inline void serialize(const std::string& filename, ucsl::resources::object_world::v3::ObjectWorldData<typename GameInterface::AllocatorSystem>& data) {
-		writeHSON(filename, [&data]() {
-			auto transformedObjects = std::views::all(data.objects) | std::views::transform([](auto* obj) {
-				auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(obj->gameObjectClass)->GetSpawnerDataClass();
+	inline void writeRflClass(util::json_writer& writer, void* obj, const typename GameInterface::RflSystem::RflClass* rflClass) {
+		rip::binary::JsonStreamSerializer<true> serializer{ writer };
+		serializer.serialize(obj, ucsl::reflection::providers::rflclass<GameInterface>::reflect(rflClass));
+	}
 
-				rfl::Object<rfl::Generic> tags{};
+	// Parameters are written next to the tags, in the parameters object itself.
+	template<typename GameInterface>
+	inline void writeRflClassFields(util::json_writer& writer, void* obj, const typename GameInterface::RflSystem::RflClass* rflClass) {
+		rip::binary::JsonStreamSerializer<true> serializer{ writer };
+		serializer.serialize_fields(obj, ucsl::reflection::providers::rflclass<GameInterface>::reflect(rflClass));
+	}
 
-				for (auto* componentData : obj->componentData) {
-					auto* componentRflClass = GameInterface::GameObjectSystem::GetInstance()->goComponentRegistry->GetComponentInformationByName(componentData->type)->GetSpawnerDataClass();
+	template<typename GameInterface>
+	inline void writeObjectWorldObject(util::json_writer& writer, auto* obj, bool hasParent) {
+		auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(obj->gameObjectClass)->GetSpawnerDataClass();
+
+		writer.begin_object();
+		writeGUID(writer, "id", obj->id);
+		writeString(writer, "name", std::string{ obj->name });
+		if (hasParent)
+			writeGUID(writer, "parentId", obj->parentID);
+		writeString(writer, "type", std::string{ obj->gameObjectClass });
+		writeTransform(writer, hasParent ? obj->localTransform.position : obj->transform.position, hasParent ? obj->localTransform.rotation : obj->transform.rotation);
+
+		writer.key("parameters");
+		writer.begin_object();
+		writer.key("tags");
+		writer.begin_object();
+
+		for (auto* componentData : obj->componentData) {
+			auto* componentRflClass = GameInterface::GameObjectSystem::GetInstance()->goComponentRegistry->GetComponentInformationByName(componentData->type)->GetSpawnerDataClass();
+
+			writer.key(componentData->type);
+			writeRflClass<GameInterface>(writer, componentData->data, componentRflClass);
+		}
+
+		writer.end_object();
+		writeRflClassFields<GameInterface>(writer, obj->spawnerData, rflClass);
+		writer.end_object();
+		writer.end_object();
+	}
 
-					tags[componentData->type] = getRflClassSerialization<GameInterface>(componentData->data, componentRflClass);
-				}
+	template<typename GameInterface>
+	inline void serialize(const std::string& filename, ucsl::resources::object_world::v2::ObjectWorldData<typename GameInterface::AllocatorSystem>& data, unsigned int jobs = 1) {
+		writeHSON(filename, [&data, jobs](util::json_writer& writer) {
+			writeArrayItems(writer, data.objects.size(), jobs, [&data](util::json_writer& writer, size_t i) {
+				auto* obj = data.objects[i];
 
-				auto position = obj->parentID.groupId != 0 || obj->parentID.objectId != 0 ? obj->localTransform.position : obj->transform.position;
-				auto rotation = util::eulerToQuat(obj->parentID.groupId != 0 || obj->parentID.objectId != 0 ? obj->localTransform.rotation : obj->transform.rotation);
-
-				return json_reflections::Object{
-					.id = util::toGUID(obj->id),
-					.name = std::string{ obj->name },
-					.parentId = obj->parentID.groupId != 0 || obj->parentID.objectId != 0 ? std::make_optional(util::toGUID(obj->parentID)) : std::nullopt,
-					.type = std::string{ obj->gameObjectClass },
-					.position = std::array<float, 3>{ position.x(), position.y(), position.z() },
-					.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-					.parameters = json_reflections::Parameters{
-						.tags = tags,
-						.parameters = getRflClassSerialization<GameInterface>(obj->spawnerData, rflClass),
-					},
-				};
+				writeObjectWorldObject<GameInterface>(writer, obj, obj->parentID.id != 0);
 			});
+		});
+	}
 
-			return std::vector<json_reflections::Object>{ transformedObjects.begin(), transformedObjects.end() };
+	template<typename GameInterface>
+	inline void serialize(const std::string& filename, ucsl::resources::object_world::v3::ObjectWorldData<typename GameInterface::AllocatorSystem>& data, unsigned int jobs = 1) {
+		writeHSON(filename, [&data, jobs](util::json_writer& writer) {
+			writeArrayItems(writer, data.objects.size(), jobs, [&data](util::json_writer& writer, size_t i) {
+				auto* obj = data.objects[i];
+
+				writeObjectWorldObject<GameInterface>(writer, obj, obj->parentID.groupId != 0 || obj->parentID.objectId != 0);
+			});
 		});
 	}
 
 	template<typename GameInterface>
-	inline void serialize(const std::string& filename, ucsl::resources::sobj::v1::SetObjectData<typename GameInterface::AllocatorSystem>& data) {
-		writeHSON(filename, [&data]() {
-			std::vector<json_reflections::Object> result{};
-			std::mt19937 mt{ std::random_device{}() };
+	inline void serialize(const std::string& filename, ucsl::resources::sobj::v1::SetObjectData<typename GameInterface::AllocatorSystem>& data, unsigned int jobs = 1) {
+		using RflClass = typename GameInterface::RflSystem::RflClass;
+
+		writeHSON(filename, [&data, jobs](util::json_writer& writer) {
+			struct Entry {
+				decltype(data.objectTypes) type;
+				const RflClass* rflClass;
+				size_t index;
+			};
+
+			std::vector<Entry> objects{};
 
 			for (auto& type : std::span{ data.objectTypes, data.objectTypeCount }) {
 				auto* rflClass = GameInterface::GameObjectSystem::GetInstance()->gameObjectRegistry->GetGameObjectClassByName(type.name)->GetSpawnerDataClass();
 
-				for (auto idx : std::span{ type.objectIndices, type.objectIndexCount }) {
-					auto* obj = data.objects[idx];
-					auto id = util::toGUID(ucsl::objectids::ObjectIdV1{ obj->id.id & 0x0000FFFF });
-
-					rfl::Object<rfl::Generic> rangeSpawning{};
-					rangeSpawning["rangeIn"] = obj->m_distance;
-					rangeSpawning["rangeOut"] = obj->m_range;
-
-					rfl::Object<rfl::Generic> tags{};
-					tags["RangeSpawning"] = rangeSpawning;
-
-					if (obj->instances.size() > 1) {
-						result.push_back({
-							.id = id,
-							.type = std::string{ type.name },
-							.isExcluded = true,
-							.parameters = json_reflections::Parameters{
-								.tags = tags,
-								.parameters = getRflClassSerialization<GameInterface>(&obj[1], rflClass),
-							},
-						});
-
-						for (auto& instance : obj->instances) {
-							auto rotation = util::eulerToQuat(instance.rotation);
-
-							result.push_back({
-								.id = util::toGUID(ucsl::objectids::ObjectIdV1{ mt() }),
-								.instanceOf = id,
-								.position = std::array<float, 3>{ instance.position.x(), instance.position.y(), instance.position.z() },
-								.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-							});
-						}
-					}
-					else {
-						auto& instance = obj->instances[0];
-						auto rotation = util::eulerToQuat(instance.rotation);
-
-						result.push_back({
-							.id = id,
-							.type = std::string{ type.name },
-							.position = std::array<float, 3>{ instance.position.x(), instance.position.y(), instance.position.z() },
-							.rotation = std::array<float, 4>{ rotation.x(), rotation.y(), rotation.z(), rotation.w() },
-							.parameters = json_reflections::Parameters{
-								.tags = tags,
-								.parameters = getRflClassSerialization<GameInterface>(&obj[1], rflClass),
-							},
-						});
-					}
-				}
+				for (auto idx : std::span{ type.objectIndices, type.objectIndexCount })
+					objects.push_back({ &type, rflClass, idx });
 			}
 
-			return result;
+			writeArrayItems(writer, objects.size(), jobs, [&data, &objects](util::json_writer& writer, size_t i) {
+				// Instance IDs are random, so each thread can have its own generator.
+				thread_local std::mt19937 mt{ std::random_device{}() };
+
+				auto& entry = objects[i];
+				auto* obj = data.objects[entry.index];
+				ucsl::objectids::ObjectIdV1 id{ obj->id.id & 0x0000FFFF };
+				bool hasInstances = obj->instances.size() > 1;
+
+				writer.begin_object();
+				writeGUID(writer, "id", id);
+				writeString(writer, "type", std::string{ entry.type->name });
+
+				if (hasInstances) {
+					writer.key("isExcluded");
+					writer.boolean(true);
+				}
+				else
+					writeTransform(writer, obj->instances[0].position, obj->instances[0].rotation);
+
+				writer.key("parameters");
+				writer.begin_object();
+				writer.key("tags");
+				writer.begin_object();
+				writer.key("RangeSpawning");
+				writer.begin_object();
+				writer.key("rangeIn");
+				writer.fp32(obj->m_distance);
+				writer.key("rangeOut");
+				writer.fp32(obj->m_range);
+				writer.end_object();
+				writer.end_object();
+				writeRflClassFields<GameInterface>(writer, &obj[1], entry.rflClass);
+				writer.end_object();
+				writer.end_object();
+
+				if (hasInstances) {
+					for (auto& instance : obj->instances) {
+						writer.begin_object();
+						writeGUID(writer, "id", ucsl::objectids::ObjectIdV1{ mt() });
+						writeGUID(writer, "instanceOf", id);
+						writeTransform(writer, instance.position, instance.rotation);
+						writer.end_object();
+					}
+				}
+			});
 		});
 	}
-}
\ No newline at end of file
+}
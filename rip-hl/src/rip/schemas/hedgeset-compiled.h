@@ -0,0 +1,520 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <rip/schemas/hedgeset.h>
+#include <rip/util/mapped-file.h>
+
+namespace rip::schemas::hedgeset {
+	/*
+	 * Compiled HedgeSet templates: the Schema built by schema_builder, stored as a flat binary file so that the
+	 * template doesn't have to be parsed and laid out again on every run.
+	 *
+	 * The file starts with a header, followed by arrays of fixed size records in the order of the header counts and
+	 * finally a string table. Records refer to each other and to strings by index/offset. A compiled schema is keyed
+	 * by a hash of the template contents and is rejected when the hash or the format version doesn't match. Bump the
+	 * version when the layout or the meaning of the stored member types changes.
+	 */
+	namespace compiled {
+		constexpr uint32_t magic = 0x43504952; // "RIPC"
+		constexpr uint32_t version = 1;
+		constexpr uint32_t none = 0xFFFFFFFF;
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t templateHash;
+			uint32_t classCount;
+			uint32_t enumCount;
+			uint32_t enumValueCount;
+			uint32_t memberCount;
+			uint32_t objectCount;
+			uint32_t componentCount;
+			uint32_t stringsSize;
+			uint32_t reserved;
+		};
+
+		struct ClassRecord {
+			uint32_t name;
+			uint32_t parent;
+			uint32_t size;
+			uint32_t firstEnum;
+			uint32_t enumCount;
+			uint32_t firstMember;
+			uint32_t memberCount;
+		};
+
+		struct EnumRecord {
+			uint32_t name;
+			uint32_t firstValue;
+			uint32_t valueCount;
+		};
+
+		struct EnumValueRecord {
+			int32_t index;
+			uint32_t englishName;
+			uint32_t japaneseName;
+		};
+
+		struct MemberRecord {
+			uint32_t name;
+			uint32_t rflClass;
+			uint32_t enumm;
+			uint32_t firstFlagValue;
+			uint32_t flagValueCount;
+			uint32_t arrayLength;
+			uint32_t offset;
+			uint8_t type;
+			uint8_t subtype;
+			uint8_t hasFlagValues;
+			uint8_t padding;
+		};
+
+		struct ObjectRecord {
+			uint32_t name;
+			uint32_t rflClass;
+			uint32_t category;
+		};
+
+		struct ComponentRecord {
+			uint32_t name;
+			uint32_t rflClass;
+		};
+	}
+
+	// 64-bit FNV-1a hash of the template file's contents.
+	inline uint64_t hash_template(const std::filesystem::path& filename) {
+		util::mapped_file file{ filename };
+		auto* bytes = static_cast<const unsigned char*>(file.data());
+		uint64_t hash = 0xCBF29CE484222325ull;
+
+		for (size_t i = 0; i < file.size(); i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ull;
+		}
+
+		return hash;
+	}
+
+	class compiled_schema_writer {
+		using RflClass = StandaloneRflSystem::RflClass;
+		using RflClassEnum = StandaloneRflSystem::RflClassEnum;
+
+		compiled::Header header{};
+		std::vector<compiled::ClassRecord> classes{};
+		std::vector<compiled::EnumRecord> enums{};
+		std::vector<compiled::EnumValueRecord> enumValues{};
+		std::vector<compiled::MemberRecord> members{};
+		std::vector<compiled::ObjectRecord> objects{};
+		std::vector<compiled::ComponentRecord> components{};
+		std::string strings{};
+		std::unordered_map<std::string, uint32_t> stringOffsets{};
+		std::unordered_map<const RflClass*, uint32_t> classIndices{};
+		std::unordered_map<const RflClassEnum*, uint32_t> enumIndices{};
+
+		uint32_t add_string(std::string_view str) {
+			auto [it, inserted] = stringOffsets.try_emplace(std::string{ str }, static_cast<uint32_t>(strings.size()));
+
+			if (inserted) {
+				strings += str;
+				strings += '\0';
+			}
+
+			return it->second;
+		}
+
+		uint32_t add_string(const char* str) {
+			return str == nullptr ? compiled::none : add_string(std::string_view{ str });
+		}
+
+		uint32_t add_string(const std::string& str) {
+			return add_string(std::string_view{ str });
+		}
+
+		uint32_t add_string(const std::optional<std::string>& str) {
+			return str.has_value() ? add_string(str.value()) : compiled::none;
+		}
+
+		uint32_t get_class_index(const RflClass* rflClass) const {
+			return rflClass == nullptr ? compiled::none : classIndices.at(rflClass);
+		}
+
+		uint32_t get_class_index(const std::optional<std::shared_ptr<RflClass>>& rflClass) const {
+			return rflClass.has_value() ? get_class_index(rflClass.value().get()) : compiled::none;
+		}
+
+		template<typename R>
+		uint32_t add_enum_values(const R& values) {
+			uint32_t first = static_cast<uint32_t>(enumValues.size());
+
+			for (auto& value : values)
+				enumValues.push_back({ value.GetIndex(), add_string(value.GetEnglishName()), add_string(value.GetJapaneseName()) });
+
+			return first;
+		}
+
+		void add_class(const RflClass& rflClass) {
+			compiled::ClassRecord record{
+				.name = add_string(rflClass.GetName()),
+				.parent = get_class_index(rflClass.parent),
+				.size = static_cast<uint32_t>(rflClass.size),
+				.firstEnum = static_cast<uint32_t>(enums.size()),
+				.enumCount = static_cast<uint32_t>(rflClass.enums.size()),
+				.firstMember = static_cast<uint32_t>(members.size()),
+				.memberCount = static_cast<uint32_t>(rflClass.members.size()),
+			};
+
+			for (auto& enumm : rflClass.enums) {
+				enumIndices[enumm.get()] = static_cast<uint32_t>(enums.size());
+				enums.push_back({ add_string(enumm->GetName()), add_enum_values(enumm->values), static_cast<uint32_t>(enumm->values.size()) });
+			}
+
+			for (auto& member : rflClass.members) {
+				bool hasFlagValues = member->GetFlagValues() ? true : false;
+				uint32_t firstFlagValue = hasFlagValues ? add_enum_values(*member->GetFlagValues()) : 0;
+
+				members.push_back({
+					.name = add_string(member->GetName()),
+					.rflClass = get_class_index(member->GetClass()),
+					.enumm = member->GetEnum() ? enumIndices.at(member->GetEnum()) : compiled::none,
+					.firstFlagValue = firstFlagValue,
+					.flagValueCount = hasFlagValues ? static_cast<uint32_t>(enumValues.size()) - firstFlagValue : 0,
+					.arrayLength = static_cast<uint32_t>(member->GetArrayLength()),
+					.offset = static_cast<uint32_t>(member->offset),
+					.type = static_cast<uint8_t>(member->GetType()),
+					.subtype = static_cast<uint8_t>(member->GetSubType()),
+					.hasFlagValues = hasFlagValues,
+				});
+			}
+
+			classes.push_back(record);
+		}
+
+		template<typename T>
+		static void write_records(std::ofstream& ofs, const std::vector<T>& records) {
+			ofs.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+		}
+
+	public:
+		// The template is used for the object and tag lists, the schema must have been built from it.
+		compiled_schema_writer(const Template& templ, const Schema& schema, uint64_t templateHash) {
+			// Indices first, as members and parents can refer to any class.
+			for (auto& [name, rflClass] : schema.classes)
+				classIndices.emplace(rflClass.get(), static_cast<uint32_t>(classIndices.size()));
+
+			for (auto& [name, rflClass] : schema.classes)
+				add_class(*rflClass);
+
+			for (auto& [name, objectDef] : templ.objects)
+				objects.push_back({ add_string(name), objectDef.structName.value().has_value() ? get_class_index(schema.classes.at(objectDef.structName.value().value()).get()) : compiled::none, add_string(objectDef.category) });
+
+			for (auto& [name, tagDef] : templ.tags)
+				components.push_back({ add_string(name), tagDef.structName.value().has_value() ? get_class_index(schema.classes.at(tagDef.structName.value().value()).get()) : compiled::none });
+
+			header = {
+				.magic = compiled::magic,
+				.version = compiled::version,
+				.templateHash = templateHash,
+				.classCount = static_cast<uint32_t>(classes.size()),
+				.enumCount = static_cast<uint32_t>(enums.size()),
+				.enumValueCount = static_cast<uint32_t>(enumValues.size()),
+				.memberCount = static_cast<uint32_t>(members.size()),
+				.objectCount = static_cast<uint32_t>(objects.size()),
+				.componentCount = static_cast<uint32_t>(components.size()),
+				.stringsSize = static_cast<uint32_t>(strings.size()),
+			};
+		}
+
+		// The file is written under a unique temporary name in the same directory and then renamed over the destination,
+		// so other processes reading or writing the same file concurrently never see a partially written file.
+		void write(const std::filesystem::path& filename) const {
+			std::random_device random{};
+			std::filesystem::path tempFilename{ filename };
+			tempFilename += ".tmp-" + std::to_string((static_cast<uint64_t>(random()) << 32) | random());
+
+			try {
+				std::ofstream ofs{ tempFilename, std::ios::binary | std::ios::trunc };
+
+				if (!ofs)
+					throw std::runtime_error{ "Could not open compiled schema file for writing." };
+
+				ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				write_records(ofs, classes);
+				write_records(ofs, enums);
+				write_records(ofs, enumValues);
+				write_records(ofs, members);
+				write_records(ofs, objects);
+				write_records(ofs, components);
+				ofs.write(strings.data(), strings.size());
+				ofs.close();
+
+				if (!ofs)
+					throw std::runtime_error{ "Could not write compiled schema file." };
+
+				std::filesystem::rename(tempFilename, filename);
+			}
+			catch (...) {
+				std::error_code ec;
+				std::filesystem::remove(tempFilename, ec);
+				throw;
+			}
+		}
+	};
+
+	class compiled_schema_reader {
+		using MemberType = StandaloneRflSystem::RflClassMember::Type;
+
+		util::mapped_file file{};
+		const compiled::Header* header{};
+		const compiled::ClassRecord* classes{};
+		const compiled::EnumRecord* enums{};
+		const compiled::EnumValueRecord* enumValues{};
+		const compiled::MemberRecord* members{};
+		const compiled::ObjectRecord* objects{};
+		const compiled::ComponentRecord* components{};
+		const char* strings{};
+
+		template<typename T>
+		bool take(const T*& records, size_t count, size_t& offset) {
+			if ((file.size() - offset) / sizeof(T) < count)
+				return false;
+
+			records = reinterpret_cast<const T*>(static_cast<const char*>(file.data()) + offset);
+			offset += count * sizeof(T);
+			return true;
+		}
+
+		bool validate_string(uint32_t offset, bool optional = false) const {
+			return offset == compiled::none ? optional : offset < header->stringsSize;
+		}
+
+		bool validate_index(uint32_t index, uint32_t count) const {
+			return index == compiled::none || index < count;
+		}
+
+		bool validate_range(uint32_t first, uint32_t count, uint32_t total) const {
+			return first <= total && count <= total - first;
+		}
+
+		// Checks all references up front, so building the schema can't read out of bounds on a damaged file.
+		bool validate() const {
+			if (header->stringsSize == 0 || strings[header->stringsSize - 1] != '\0')
+				return false;
+
+			for (uint32_t i = 0; i < header->classCount; i++) {
+				auto& record = classes[i];
+
+				if (!validate_string(record.name) || !validate_index(record.parent, header->classCount) || !validate_range(record.firstEnum, record.enumCount, header->enumCount) || !validate_range(record.firstMember, record.memberCount, header->memberCount))
+					return false;
+			}
+
+			for (uint32_t i = 0; i < header->enumCount; i++)
+				if (!validate_string(enums[i].name) || !validate_range(enums[i].firstValue, enums[i].valueCount, header->enumValueCount))
+					return false;
+
+			for (uint32_t i = 0; i < header->enumValueCount; i++)
+				if (!validate_string(enumValues[i].englishName) || !validate_string(enumValues[i].japaneseName, true))
+					return false;
+
+			for (uint32_t i = 0; i < header->memberCount; i++) {
+				auto& record = members[i];
+
+				if (!validate_string(record.name) || !validate_index(record.rflClass, header->classCount) || !validate_index(record.enumm, header->enumCount) || !validate_range(record.firstFlagValue, record.flagValueCount, header->enumValueCount))
+					return false;
+			}
+
+			for (uint32_t i = 0; i < header->objectCount; i++)
+				if (!validate_string(objects[i].name) || !validate_index(objects[i].rflClass, header->classCount) || !validate_string(objects[i].category, true))
+					return false;
+
+			for (uint32_t i = 0; i < header->componentCount; i++)
+				if (!validate_string(components[i].name) || !validate_index(components[i].rflClass, header->classCount))
+					return false;
+
+			return true;
+		}
+
+		const char* get_string(uint32_t offset) const {
+			return offset == compiled::none ? nullptr : strings + offset;
+		}
+
+		std::vector<StandaloneRflSystem::RflClassEnumMember> get_enum_values(uint32_t first, uint32_t count) const {
+			std::vector<StandaloneRflSystem::RflClassEnumMember> values{};
+			values.reserve(count);
+
+			for (uint32_t i = first; i < first + count; i++) {
+				const char* japaneseName = get_string(enumValues[i].japaneseName);
+
+				values.push_back(StandaloneRflSystem::RflClassEnumMember{ enumValues[i].index, get_string(enumValues[i].englishName), japaneseName ? japaneseName : "" });
+			}
+
+			return values;
+		}
+
+	public:
+		// Returns false if the file doesn't exist, is damaged, or was compiled from a different template or by a different format version.
+		bool open(const std::filesystem::path& filename, uint64_t templateHash) {
+			std::error_code ec;
+			if (!std::filesystem::is_regular_file(filename, ec))
+				return false;
+
+			try {
+				file = util::mapped_file{ filename };
+			}
+			catch (std::runtime_error&) {
+				return false;
+			}
+
+			size_t offset{};
+
+			bool valid = take(header, 1, offset)
+				&& header->magic == compiled::magic
+				&& header->version == compiled::version
+				&& header->templateHash == templateHash
+				&& take(classes, header->classCount, offset)
+				&& take(enums, header->enumCount, offset)
+				&& take(enumValues, header->enumValueCount, offset)
+				&& take(members, header->memberCount, offset)
+				&& take(objects, header->objectCount, offset)
+				&& take(components, header->componentCount, offset)
+				&& take(strings, header->stringsSize, offset)
+				&& offset == file.size()
+				&& validate();
+
+			// A rejected file is about to be replaced, which fails on some platforms while it is still mapped.
+			if (!valid)
+				file = util::mapped_file{};
+
+			return valid;
+		}
+
+		Schema get_schema() const {
+			return get_schema([](const char* name) { return true; });
+		}
+
+		/*
+		 * Only builds the objects, components and classes whose name isUsed returns true for, together with the
+		 * classes they depend on. Everything else in the compiled schema is skipped.
+		 */
+		template<typename F>
+		Schema get_schema(F isUsed) const {
+			Schema schema{};
+			std::vector<bool> usedObjects(header->objectCount);
+			std::vector<bool> usedComponents(header->componentCount);
+			std::vector<bool> usedClasses(header->classCount);
+			std::vector<uint32_t> pending{};
+
+			auto markClass = [&usedClasses, &pending](uint32_t index) {
+				if (index != compiled::none && !usedClasses[index]) {
+					usedClasses[index] = true;
+					pending.push_back(index);
+				}
+			};
+
+			for (uint32_t i = 0; i < header->objectCount; i++)
+				if ((usedObjects[i] = isUsed(get_string(objects[i].name))))
+					markClass(objects[i].rflClass);
+
+			for (uint32_t i = 0; i < header->componentCount; i++)
+				if ((usedComponents[i] = isUsed(get_string(components[i].name))))
+					markClass(components[i].rflClass);
+
+			for (uint32_t i = 0; i < header->classCount; i++)
+				if (isUsed(get_string(classes[i].name)))
+					markClass(i);
+
+			while (!pending.empty()) {
+				auto& record = classes[pending.back()];
+				pending.pop_back();
+
+				markClass(record.parent);
+
+				for (uint32_t j = record.firstMember; j < record.firstMember + record.memberCount; j++)
+					markClass(members[j].rflClass);
+			}
+
+			std::vector<std::shared_ptr<StandaloneRflSystem::RflClass>> classPtrs(header->classCount);
+			std::vector<std::shared_ptr<StandaloneRflSystem::RflClassEnum>> enumPtrs(header->enumCount);
+
+			// Classes are created up front and filled in afterwards, as members and parents can refer to any class.
+			for (uint32_t i = 0; i < header->classCount; i++) {
+				if (!usedClasses[i])
+					continue;
+
+				const char* name = get_string(classes[i].name);
+
+				classPtrs[i] = schema.classes.emplace(name, std::make_shared<StandaloneRflSystem::RflClass>(name, std::nullopt, 0, std::vector<std::shared_ptr<StandaloneRflSystem::RflClassEnum>>{}, std::vector<std::shared_ptr<StandaloneRflSystem::RflClassMember>>{}, 0)).first->second;
+			}
+
+			auto getClass = [&classPtrs](uint32_t index) {
+				return index == compiled::none ? std::nullopt : std::make_optional(classPtrs[index]);
+			};
+
+			auto getEnum = [this, &enumPtrs](uint32_t index) {
+				if (!enumPtrs[index])
+					enumPtrs[index] = std::make_shared<StandaloneRflSystem::RflClassEnum>(get_string(enums[index].name), get_enum_values(enums[index].firstValue, enums[index].valueCount));
+
+				return enumPtrs[index];
+			};
+
+			for (uint32_t i = 0; i < header->classCount; i++) {
+				if (!usedClasses[i])
+					continue;
+
+				auto& record = classes[i];
+				auto& res = classPtrs[i];
+
+				res->parent = getClass(record.parent);
+
+				for (uint32_t j = record.firstEnum; j < record.firstEnum + record.enumCount; j++)
+					res->enums.push_back(getEnum(j));
+
+				std::vector<std::shared_ptr<StandaloneRflSystem::RflClassMember>> classMembers{};
+				classMembers.reserve(record.memberCount);
+
+				for (uint32_t j = record.firstMember; j < record.firstMember + record.memberCount; j++) {
+					auto& memberRecord = members[j];
+
+					auto member = classMembers.emplace_back(std::make_shared<StandaloneRflSystem::RflClassMember>(
+						get_string(memberRecord.name),
+						getClass(memberRecord.rflClass),
+						memberRecord.enumm == compiled::none ? std::nullopt : std::make_optional(getEnum(memberRecord.enumm)),
+						memberRecord.hasFlagValues ? std::make_optional(get_enum_values(memberRecord.firstFlagValue, memberRecord.flagValueCount)) : std::nullopt,
+						static_cast<MemberType>(memberRecord.type),
+						static_cast<MemberType>(memberRecord.subtype),
+						memberRecord.arrayLength,
+						0
+					));
+
+					member->offset = memberRecord.offset;
+				}
+
+				res->members = std::move(classMembers);
+				res->size = record.size;
+			}
+
+			for (uint32_t i = 0; i < header->objectCount; i++) {
+				if (!usedObjects[i])
+					continue;
+
+				const char* category = get_string(objects[i].category);
+
+				schema.objects.emplace(get_string(objects[i].name), Schema::ObjectInfo{ getClass(objects[i].rflClass), category ? std::make_optional<std::string>(category) : std::nullopt });
+			}
+
+			for (uint32_t i = 0; i < header->componentCount; i++)
+				if (usedComponents[i])
+					schema.components.emplace(get_string(components[i].name), Schema::ComponentInfo{ getClass(components[i].rflClass) });
+
+			return schema;
+		}
+	};
+}
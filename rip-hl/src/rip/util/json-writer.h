@@ -0,0 +1,319 @@
+#pragma once
+#include <yyjson.h>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cassert>
+
+namespace rip::util {
+	/*
+	 * Writes JSON text straight to a stream, producing the same output as yyjson's writer for the same flags.
+	 * Supported flags are YYJSON_WRITE_PRETTY, YYJSON_WRITE_PRETTY_TWO_SPACES, YYJSON_WRITE_ESCAPE_SLASHES,
+	 * YYJSON_WRITE_ALLOW_INF_AND_NAN and YYJSON_WRITE_INF_AND_NAN_AS_NULL. Strings are not validated, as with
+	 * YYJSON_WRITE_ALLOW_INVALID_UNICODE.
+	 *
+	 * Object keys are held back until a value is written for them, so a key can be dropped by not writing a value.
+	 * This mirrors yyjson_mut_obj_add_val ignoring null values.
+	 *
+	 * A writer can also produce a fragment: items of an array in another writer's document, written separately
+	 * (e.g. on another thread) and added to that array with append_items.
+	 */
+	class json_writer {
+		struct Level {
+			bool isObject;
+			bool empty;
+		};
+
+		static constexpr size_t flushThreshold = 64 * 1024;
+
+		std::ostream& stream;
+		std::vector<char> buffer{};
+		std::vector<Level> levels{};
+		const char* pendingKey{};
+		yyjson_write_flag flags{};
+		size_t depthOffset{};
+		size_t indentSize{};
+		bool escapeSlashes{};
+		bool allowInfAndNan{};
+		bool infAndNanAsNull{};
+
+		inline char* reserve(size_t size) {
+			size_t pos = buffer.size();
+			buffer.resize(pos + size);
+			return buffer.data() + pos;
+		}
+
+		inline void commit(char* end) {
+			buffer.resize(end - buffer.data());
+
+			if (buffer.size() >= flushThreshold)
+				flush();
+		}
+
+		inline void put(char c) {
+			buffer.push_back(c);
+		}
+
+		inline void put(const char* str, size_t length) {
+			buffer.insert(buffer.end(), str, str + length);
+		}
+
+		void newline(size_t depth) {
+			put('\n');
+			buffer.insert(buffer.end(), (depth + depthOffset) * indentSize, ' ');
+		}
+
+		void writeQuoted(const char* str, size_t length) {
+			static constexpr char hex[] = "0123456789ABCDEF";
+
+			put('"');
+
+			size_t runStart = 0;
+
+			for (size_t i = 0; i < length; i++) {
+				unsigned char c = static_cast<unsigned char>(str[i]);
+
+				if (c >= 0x20 && c != '"' && c != '\\' && !(c == '/' && escapeSlashes))
+					continue;
+
+				put(str + runStart, i - runStart);
+				runStart = i + 1;
+
+				switch (c) {
+				case '"': put("\\\"", 2); break;
+				case '\\': put("\\\\", 2); break;
+				case '/': put("\\/", 2); break;
+				case '\b': put("\\b", 2); break;
+				case '\f': put("\\f", 2); break;
+				case '\n': put("\\n", 2); break;
+				case '\r': put("\\r", 2); break;
+				case '\t': put("\\t", 2); break;
+				default: {
+					char escape[6]{ '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+					put(escape, 6);
+					break;
+				}
+				}
+			}
+
+			put(str + runStart, length - runStart);
+			put('"');
+		}
+
+		void beginValue() {
+			if (levels.empty())
+				return;
+
+			Level& level = levels.back();
+
+			assert((!level.isObject || pendingKey) && "values in an object need a key");
+
+			if (!level.empty)
+				put(',');
+
+			if (indentSize)
+				newline(levels.size());
+
+			level.empty = false;
+
+			if (level.isObject) {
+				writeQuoted(pendingKey, strlen(pendingKey));
+				put(':');
+
+				if (indentSize)
+					put(' ');
+
+				pendingKey = nullptr;
+			}
+		}
+
+		void beginContainer(char c, bool isObject) {
+			beginValue();
+			put(c);
+			levels.push_back({ isObject, true });
+		}
+
+		void endContainer(char c) {
+			bool empty = levels.back().empty;
+
+			levels.pop_back();
+			pendingKey = nullptr;
+
+			if (!empty && indentSize)
+				newline(levels.size());
+
+			put(c);
+			commit(buffer.data() + buffer.size());
+		}
+
+		bool writeNonFinite(double value) {
+			if (std::isfinite(value))
+				return false;
+
+			beginValue();
+
+			if (infAndNanAsNull)
+				put("null", 4);
+			else if (!allowInfAndNan)
+				throw std::runtime_error{ "nan or inf number is not allowed" };
+			else if (std::isnan(value))
+				put("NaN", 3);
+			else if (value < 0)
+				put("-Infinity", 9);
+			else
+				put("Infinity", 8);
+
+			return true;
+		}
+
+		void writeNumber(const yyjson_mut_val& value) {
+			beginValue();
+			char* end = yyjson_mut_write_number(&value, reserve(40));
+			assert(end != nullptr);
+			commit(end);
+		}
+
+		template<typename T>
+		void writeInteger(T value) {
+			beginValue();
+			char* start = reserve(24);
+			commit(std::to_chars(start, start + 24, value).ptr);
+		}
+
+	public:
+		json_writer(std::ostream& stream, yyjson_write_flag flags = YYJSON_WRITE_NOFLAG)
+			: stream{ stream }
+			, flags{ flags }
+			, indentSize{ (flags & YYJSON_WRITE_PRETTY_TWO_SPACES) ? 2u : (flags & YYJSON_WRITE_PRETTY) ? 4u : 0u }
+			, escapeSlashes{ (flags & YYJSON_WRITE_ESCAPE_SLASHES) != 0 }
+			, allowInfAndNan{ (flags & YYJSON_WRITE_ALLOW_INF_AND_NAN) != 0 }
+			, infAndNanAsNull{ (flags & YYJSON_WRITE_INF_AND_NAN_AS_NULL) != 0 } {
+			buffer.reserve(flushThreshold + 1024);
+		}
+
+		// Creates a fragment writer for items of an array that is `arrayDepth` levels deep in the target document.
+		json_writer(std::ostream& stream, yyjson_write_flag flags, size_t arrayDepth) : json_writer{ stream, flags } {
+			assert(arrayDepth > 0);
+			levels.push_back({ false, true });
+			depthOffset = arrayDepth - 1;
+		}
+
+		json_writer(const json_writer&) = delete;
+		json_writer& operator=(const json_writer&) = delete;
+
+		~json_writer() {
+			flush();
+		}
+
+		void begin_object() {
+			beginContainer('{', true);
+		}
+
+		void end_object() {
+			endContainer('}');
+		}
+
+		void begin_array() {
+			beginContainer('[', false);
+		}
+
+		void end_array() {
+			endContainer(']');
+		}
+
+		// Sets the key of the next value. The string must stay alive until that value is written.
+		void key(const char* name) {
+			pendingKey = name;
+		}
+
+		void null() {
+			beginValue();
+			put("null", 4);
+		}
+
+		void boolean(bool value) {
+			beginValue();
+
+			if (value)
+				put("true", 4);
+			else
+				put("false", 5);
+		}
+
+		void sint(int64_t value) {
+			writeInteger(value);
+		}
+
+		void uint(uint64_t value) {
+			writeInteger(value);
+		}
+
+		void real(double value) {
+			if (writeNonFinite(value))
+				return;
+
+			yyjson_mut_val val;
+			yyjson_mut_set_real(&val, value);
+			writeNumber(val);
+		}
+
+		void fp32(float value) {
+			if (writeNonFinite(value))
+				return;
+
+			yyjson_mut_val val;
+			yyjson_mut_set_float(&val, value);
+			writeNumber(val);
+		}
+
+		void string(const char* str) {
+			string(str, strlen(str));
+		}
+
+		void string(const char* str, size_t length) {
+			beginValue();
+			writeQuoted(str, length);
+			commit(buffer.data() + buffer.size());
+		}
+
+		yyjson_write_flag get_flags() const {
+			return flags;
+		}
+
+		// Number of containers that are currently open.
+		size_t depth() const {
+			return levels.size();
+		}
+
+		// Adds the output of a fragment writer to the array that is currently open.
+		void append_items(const std::string& items) {
+			assert(!levels.empty() && !levels.back().isObject && "fragments can only be appended to an array");
+
+			if (items.empty())
+				return;
+
+			Level& level = levels.back();
+
+			if (!level.empty)
+				put(',');
+
+			level.empty = false;
+
+			put(items.data(), items.size());
+			commit(buffer.data() + buffer.size());
+		}
+
+		void flush() {
+			if (buffer.empty())
+				return;
+
+			stream.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	};
+}
@@ -0,0 +1,180 @@
+#include <stdexcept>
+#include <utility>
+#include <fstream>
+#include "mapped-file.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rip::util {
+#ifdef _WIN32
+	static size_t getPageSize() {
+		SYSTEM_INFO info{};
+		GetSystemInfo(&info);
+		return info.dwPageSize;
+	}
+
+	static void* allocateAnonymous(size_t size) {
+		return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	}
+
+	mapped_file::mapped_file(const std::filesystem::path& path, size_t padding) {
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error{ "Could not open input file." };
+
+		LARGE_INTEGER fileSize{};
+
+		if (!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			throw std::runtime_error{ "Could not determine input file size." };
+		}
+
+		if (fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			throw std::runtime_error{ "Input file is empty." };
+		}
+
+		length = static_cast<size_t>(fileSize.QuadPart);
+
+		if (padding > 0 && (length % getPageSize() == 0 || getPageSize() - length % getPageSize() < padding)) {
+			CloseHandle(file);
+			readAnonymous(path, padding);
+			return;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(file);
+
+		if (mapping == nullptr)
+			throw std::runtime_error{ "Could not map input file." };
+
+		address = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(mapping);
+
+		if (address == nullptr)
+			throw std::runtime_error{ "Could not map input file." };
+
+		mappedLength = length;
+
+		// The deserializers jump around the whole file, so ask for all of it up front. This is only a hint.
+		WIN32_MEMORY_RANGE_ENTRY range{ address, length };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+
+	void mapped_file::unmap() noexcept {
+		if (!address)
+			return;
+
+		if (anonymous)
+			VirtualFree(address, 0, MEM_RELEASE);
+		else
+			UnmapViewOfFile(address);
+	}
+#else
+	static size_t getPageSize() {
+		return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	static void* allocateAnonymous(size_t size) {
+		void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return addr == MAP_FAILED ? nullptr : addr;
+	}
+
+	mapped_file::mapped_file(const std::filesystem::path& path, size_t padding) {
+		int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+		if (fd == -1)
+			throw std::runtime_error{ "Could not open input file." };
+
+		struct stat st{};
+
+		if (fstat(fd, &st) == -1) {
+			close(fd);
+			throw std::runtime_error{ "Could not determine input file size." };
+		}
+
+		if (st.st_size == 0) {
+			close(fd);
+			throw std::runtime_error{ "Input file is empty." };
+		}
+
+		length = static_cast<size_t>(st.st_size);
+
+		if (padding > 0 && (length % getPageSize() == 0 || getPageSize() - length % getPageSize() < padding)) {
+			close(fd);
+			readAnonymous(path, padding);
+			return;
+		}
+
+		void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (addr == MAP_FAILED)
+			throw std::runtime_error{ "Could not map input file." };
+
+		address = addr;
+		mappedLength = length;
+
+		// The deserializers jump around the whole file, so ask for all of it up front. This is only a hint.
+		madvise(address, length, MADV_WILLNEED);
+	}
+
+	void mapped_file::unmap() noexcept {
+		if (address)
+			munmap(address, mappedLength);
+	}
+#endif
+
+	void mapped_file::readAnonymous(const std::filesystem::path& path, size_t padding) {
+		mappedLength = length + padding;
+		address = allocateAnonymous(mappedLength);
+		anonymous = true;
+
+		if (address == nullptr)
+			throw std::runtime_error{ "Could not allocate memory for input file." };
+
+		std::ifstream stream{ path, std::ios::binary };
+
+		if (!stream.read(static_cast<char*>(address), length)) {
+			unmap();
+			address = nullptr;
+			throw std::runtime_error{ "Could not read input file." };
+		}
+	}
+
+	mapped_file::mapped_file(mapped_file&& other) noexcept
+		: address{ std::exchange(other.address, nullptr) }
+		, length{ std::exchange(other.length, 0) }
+		, mappedLength{ std::exchange(other.mappedLength, 0) }
+		, anonymous{ std::exchange(other.anonymous, false) } {
+	}
+
+	mapped_file::~mapped_file() {
+		unmap();
+	}
+
+	mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+		if (this != &other) {
+			unmap();
+			address = std::exchange(other.address, nullptr);
+			length = std::exchange(other.length, 0);
+			mappedLength = std::exchange(other.mappedLength, 0);
+			anonymous = std::exchange(other.anonymous, false);
+		}
+		return *this;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+
+namespace rip::util {
+	/*
+	 * Private, copy-on-write mapping of an entire file.
+	 * Pages can be written to (e.g. by resolvers fixing up offsets in place) without touching the file on disk.
+	 * If padding is requested, at least that many zero bytes are guaranteed to follow the file contents. When the
+	 * last page doesn't have enough room left for that, the file is read into anonymous memory instead.
+	 */
+	class mapped_file {
+		void* address{};
+		size_t length{};
+		size_t mappedLength{};
+		bool anonymous{};
+
+		void unmap() noexcept;
+		void readAnonymous(const std::filesystem::path& path, size_t padding);
+
+	public:
+		mapped_file() = default;
+		explicit mapped_file(const std::filesystem::path& path, size_t padding = 0);
+		mapped_file(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept;
+		~mapped_file();
+
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file& operator=(mapped_file&& other) noexcept;
+
+		inline void* data() const noexcept {
+			return address;
+		}
+
+		inline size_t size() const noexcept {
+			return length;
+		}
+	};
+}
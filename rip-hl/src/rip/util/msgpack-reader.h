@@ -0,0 +1,289 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace rip::util {
+	/*
+	 * A parsed MessagePack value. Strings point into the parsed buffer, which has to stay alive as long as the document.
+	 * Items of an array and key/value pairs of a map are stored next to each other, so they can be indexed directly.
+	 */
+	class msgpack_value {
+		friend class msgpack_document;
+
+	public:
+		enum class Type : uint8_t {
+			NIL,
+			BOOL,
+			UINT,
+			SINT,
+			FLOAT,
+			STR,
+			BIN,
+			ARRAY,
+			MAP,
+		};
+
+	private:
+		Type type{};
+		uint32_t length{};
+		union {
+			bool b;
+			uint64_t u;
+			int64_t i;
+			double f;
+			const char* str;
+			const msgpack_value* children;
+		};
+
+	public:
+		msgpack_value() : u{} {}
+
+		inline Type get_type() const {
+			return type;
+		}
+
+		inline bool is_nil() const {
+			return type == Type::NIL;
+		}
+
+		inline bool is_str() const {
+			return type == Type::STR;
+		}
+
+		inline bool is_map() const {
+			return type == Type::MAP;
+		}
+
+		inline bool get_bool() const {
+			return type == Type::BOOL && b;
+		}
+
+		inline uint64_t get_uint() const {
+			return type == Type::UINT ? u : type == Type::SINT ? static_cast<uint64_t>(i) : type == Type::FLOAT ? static_cast<uint64_t>(f) : 0;
+		}
+
+		inline int64_t get_sint() const {
+			return type == Type::SINT ? i : type == Type::UINT ? static_cast<int64_t>(u) : type == Type::FLOAT ? static_cast<int64_t>(f) : 0;
+		}
+
+		inline double get_num() const {
+			return type == Type::FLOAT ? f : type == Type::UINT ? static_cast<double>(u) : type == Type::SINT ? static_cast<double>(i) : 0.0;
+		}
+
+		// Not null terminated.
+		inline const char* get_str() const {
+			return type == Type::STR || type == Type::BIN ? str : nullptr;
+		}
+
+		inline size_t get_len() const {
+			return type == Type::STR || type == Type::BIN ? length : 0;
+		}
+
+		inline std::string_view get_view() const {
+			return { get_str(), get_len() };
+		}
+
+		// Number of items in an array or pairs in a map.
+		inline size_t size() const {
+			return type == Type::ARRAY || type == Type::MAP ? length : 0;
+		}
+
+		inline const msgpack_value* item(size_t index) const {
+			return type == Type::ARRAY && index < length ? &children[index] : nullptr;
+		}
+
+		inline const msgpack_value* key_at(size_t index) const {
+			return type == Type::MAP && index < length ? &children[index * 2] : nullptr;
+		}
+
+		inline const msgpack_value* value_at(size_t index) const {
+			return type == Type::MAP && index < length ? &children[index * 2 + 1] : nullptr;
+		}
+
+		// Linear search, returns the first value with this key or nullptr.
+		const msgpack_value* get(std::string_view key) const {
+			for (size_t i = 0; i < size(); i++)
+				if (key_at(i)->is_str() && key_at(i)->get_view() == key)
+					return value_at(i);
+
+			return nullptr;
+		}
+	};
+
+	/*
+	 * Parses a single MessagePack value from a buffer. Extension types are not supported.
+	 */
+	class msgpack_document {
+		std::vector<msgpack_value> values{};
+		const char* error{};
+
+		const uint8_t* pos{};
+		const uint8_t* end{};
+
+		bool fail(const char* message) {
+			error = message;
+			return false;
+		}
+
+		bool readBigEndian(size_t width, uint64_t& result) {
+			if (static_cast<size_t>(end - pos) < width)
+				return fail("unexpected end of data");
+
+			result = 0;
+			for (size_t i = 0; i < width; i++)
+				result = (result << 8) | *pos++;
+
+			return true;
+		}
+
+		bool readBytes(msgpack_value& value, msgpack_value::Type type, uint64_t length) {
+			if (static_cast<uint64_t>(end - pos) < length)
+				return fail("unexpected end of data");
+
+			value.type = type;
+			value.length = static_cast<uint32_t>(length);
+			value.str = reinterpret_cast<const char*>(pos);
+			pos += length;
+			return true;
+		}
+
+		// Children are placed after all values that were allocated so far and linked up by index, as the vector
+		// can still grow. Indices are replaced with pointers once the whole document is parsed.
+		bool readChildren(size_t index, msgpack_value::Type type, uint64_t count, size_t depth) {
+			uint64_t childCount = type == msgpack_value::Type::MAP ? count * 2 : count;
+
+			// Every value takes at least one byte, so this also protects against absurd sizes in corrupt data.
+			if (static_cast<uint64_t>(end - pos) < childCount)
+				return fail("unexpected end of data");
+
+			size_t first = values.size();
+
+			values[index].type = type;
+			values[index].length = static_cast<uint32_t>(count);
+			values[index].u = first;
+			values.resize(first + childCount);
+
+			for (size_t i = 0; i < childCount; i++)
+				if (!readValue(first + i, depth + 1))
+					return false;
+
+			return true;
+		}
+
+		bool readValue(size_t index, size_t depth) {
+			if (depth > 512)
+				return fail("nesting too deep");
+
+			if (pos == end)
+				return fail("unexpected end of data");
+
+			uint8_t tag = *pos++;
+			uint64_t v;
+
+			auto& value = values[index];
+
+			if (tag <= 0x7F) {
+				value.type = msgpack_value::Type::UINT;
+				value.u = tag;
+				return true;
+			}
+
+			if (tag >= 0xE0) {
+				value.type = msgpack_value::Type::SINT;
+				value.i = static_cast<int8_t>(tag);
+				return true;
+			}
+
+			if ((tag & 0xF0) == 0x80)
+				return readChildren(index, msgpack_value::Type::MAP, tag & 0x0F, depth);
+
+			if ((tag & 0xF0) == 0x90)
+				return readChildren(index, msgpack_value::Type::ARRAY, tag & 0x0F, depth);
+
+			if ((tag & 0xE0) == 0xA0)
+				return readBytes(value, msgpack_value::Type::STR, tag & 0x1F);
+
+			switch (tag) {
+			case 0xC0: value.type = msgpack_value::Type::NIL; return true;
+			case 0xC2: value.type = msgpack_value::Type::BOOL; value.b = false; return true;
+			case 0xC3: value.type = msgpack_value::Type::BOOL; value.b = true; return true;
+			case 0xC4: return readBigEndian(1, v) && readBytes(value, msgpack_value::Type::BIN, v);
+			case 0xC5: return readBigEndian(2, v) && readBytes(value, msgpack_value::Type::BIN, v);
+			case 0xC6: return readBigEndian(4, v) && readBytes(value, msgpack_value::Type::BIN, v);
+			case 0xCA:
+				if (!readBigEndian(4, v))
+					return false;
+				value.type = msgpack_value::Type::FLOAT;
+				value.f = std::bit_cast<float>(static_cast<uint32_t>(v));
+				return true;
+			case 0xCB:
+				if (!readBigEndian(8, v))
+					return false;
+				value.type = msgpack_value::Type::FLOAT;
+				value.f = std::bit_cast<double>(v);
+				return true;
+			case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+				if (!readBigEndian(size_t{ 1 } << (tag - 0xCC), v))
+					return false;
+				value.type = msgpack_value::Type::UINT;
+				value.u = v;
+				return true;
+			case 0xD0: case 0xD1: case 0xD2: case 0xD3: {
+				size_t width = size_t{ 1 } << (tag - 0xD0);
+
+				if (!readBigEndian(width, v))
+					return false;
+
+				// Sign extend.
+				unsigned int shift = static_cast<unsigned int>(64 - width * 8);
+
+				value.type = msgpack_value::Type::SINT;
+				value.i = static_cast<int64_t>(v << shift) >> shift;
+				return true;
+			}
+			case 0xD9: return readBigEndian(1, v) && readBytes(value, msgpack_value::Type::STR, v);
+			case 0xDA: return readBigEndian(2, v) && readBytes(value, msgpack_value::Type::STR, v);
+			case 0xDB: return readBigEndian(4, v) && readBytes(value, msgpack_value::Type::STR, v);
+			case 0xDC: return readBigEndian(2, v) && readChildren(index, msgpack_value::Type::ARRAY, v, depth);
+			case 0xDD: return readBigEndian(4, v) && readChildren(index, msgpack_value::Type::ARRAY, v, depth);
+			case 0xDE: return readBigEndian(2, v) && readChildren(index, msgpack_value::Type::MAP, v, depth);
+			case 0xDF: return readBigEndian(4, v) && readChildren(index, msgpack_value::Type::MAP, v, depth);
+			default: return fail("unsupported type");
+			}
+		}
+
+	public:
+		// Returns false on malformed data, see get_error.
+		bool parse(const void* data, size_t size) {
+			values.clear();
+			error = nullptr;
+			pos = static_cast<const uint8_t*>(data);
+			end = pos + size;
+
+			values.resize(1);
+
+			if (!readValue(0, 0))
+				return false;
+
+			if (pos != end)
+				return fail("trailing data after value");
+
+			for (auto& value : values)
+				if (value.type == msgpack_value::Type::ARRAY || value.type == msgpack_value::Type::MAP)
+					value.children = value.length == 0 ? nullptr : &values[value.u];
+
+			return true;
+		}
+
+		const msgpack_value* get_root() const {
+			return values.empty() || error ? nullptr : &values[0];
+		}
+
+		const char* get_error() const {
+			return error;
+		}
+	};
+}
@@ -0,0 +1,225 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+namespace rip::util {
+	/*
+	 * Writes MessagePack data to a stream, always using the smallest encoding for a value.
+	 *
+	 * Arrays and maps don't need to know their size up front. Their headers are filled in once the outermost
+	 * container is closed, so a value is held in memory until then.
+	 *
+	 * As with json_writer, map keys are held back until a value is written for them, so a key can be dropped by not
+	 * writing a value.
+	 */
+	class msgpack_writer {
+		struct Container {
+			size_t position;
+			size_t count;
+			bool isMap;
+		};
+
+		std::ostream& stream;
+		std::vector<char> buffer{};
+		std::vector<Container> containers{};
+		std::vector<size_t> openContainers{};
+		const char* pendingKey{};
+
+		inline void put(uint8_t c) {
+			buffer.push_back(static_cast<char>(c));
+		}
+
+		template<typename T>
+		inline void putBigEndian(uint8_t tag, T value) {
+			put(tag);
+
+			for (size_t i = sizeof(T); i > 0; i--)
+				put(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+		}
+
+		// Writes a header whose size is the smallest of the given tags that can hold it.
+		static size_t writeHeader(char* out, size_t size, uint8_t fixTag, size_t fixMax, uint8_t tag8, uint8_t tag16, uint8_t tag32) {
+			if (size <= fixMax) {
+				out[0] = static_cast<char>(fixTag | size);
+				return 1;
+			}
+
+			size_t width = tag8 != 0 && size <= 0xFF ? 1 : size <= 0xFFFF ? 2 : 4;
+
+			out[0] = static_cast<char>(width == 1 ? tag8 : width == 2 ? tag16 : tag32);
+
+			for (size_t i = 0; i < width; i++)
+				out[1 + i] = static_cast<char>(size >> ((width - 1 - i) * 8));
+
+			return 1 + width;
+		}
+
+		void writeString(const char* str, size_t length) {
+			char header[5];
+			size_t headerSize = writeHeader(header, length, 0xA0, 31, 0xD9, 0xDA, 0xDB);
+
+			buffer.insert(buffer.end(), header, header + headerSize);
+			buffer.insert(buffer.end(), str, str + length);
+		}
+
+		void beginValue() {
+			if (openContainers.empty())
+				return;
+
+			auto& container = containers[openContainers.back()];
+
+			assert((!container.isMap || pendingKey) && "values in a map need a key");
+
+			container.count++;
+
+			if (container.isMap) {
+				writeString(pendingKey, strlen(pendingKey));
+				pendingKey = nullptr;
+			}
+		}
+
+		void beginContainer(bool isMap) {
+			beginValue();
+			openContainers.push_back(containers.size());
+			containers.push_back({ buffer.size(), 0, isMap });
+		}
+
+		void endContainer(bool isMap) {
+			assert(!openContainers.empty() && containers[openContainers.back()].isMap == isMap && "mismatched container end");
+
+			openContainers.pop_back();
+			pendingKey = nullptr;
+
+			if (openContainers.empty())
+				flush();
+		}
+
+	public:
+		msgpack_writer(std::ostream& stream) : stream{ stream } {}
+
+		msgpack_writer(const msgpack_writer&) = delete;
+		msgpack_writer& operator=(const msgpack_writer&) = delete;
+
+		~msgpack_writer() {
+			flush();
+		}
+
+		void begin_map() {
+			beginContainer(true);
+		}
+
+		void end_map() {
+			endContainer(true);
+		}
+
+		void begin_array() {
+			beginContainer(false);
+		}
+
+		void end_array() {
+			endContainer(false);
+		}
+
+		// Sets the key of the next value. The string must stay alive until that value is written.
+		void key(const char* name) {
+			pendingKey = name;
+		}
+
+		void nil() {
+			beginValue();
+			put(0xC0);
+		}
+
+		void boolean(bool value) {
+			beginValue();
+			put(value ? 0xC3 : 0xC2);
+		}
+
+		void uint(uint64_t value) {
+			beginValue();
+
+			if (value <= 0x7F)
+				put(static_cast<uint8_t>(value));
+			else if (value <= 0xFF)
+				putBigEndian(0xCC, static_cast<uint8_t>(value));
+			else if (value <= 0xFFFF)
+				putBigEndian(0xCD, static_cast<uint16_t>(value));
+			else if (value <= 0xFFFFFFFF)
+				putBigEndian(0xCE, static_cast<uint32_t>(value));
+			else
+				putBigEndian(0xCF, value);
+		}
+
+		void sint(int64_t value) {
+			if (value >= 0) {
+				uint(static_cast<uint64_t>(value));
+				return;
+			}
+
+			beginValue();
+
+			if (value >= -32)
+				put(static_cast<uint8_t>(value));
+			else if (value >= INT8_MIN)
+				putBigEndian(0xD0, static_cast<uint8_t>(value));
+			else if (value >= INT16_MIN)
+				putBigEndian(0xD1, static_cast<uint16_t>(value));
+			else if (value >= INT32_MIN)
+				putBigEndian(0xD2, static_cast<uint32_t>(value));
+			else
+				putBigEndian(0xD3, static_cast<uint64_t>(value));
+		}
+
+		void fp32(float value) {
+			beginValue();
+			putBigEndian(0xCA, std::bit_cast<uint32_t>(value));
+		}
+
+		void real(double value) {
+			beginValue();
+			putBigEndian(0xCB, std::bit_cast<uint64_t>(value));
+		}
+
+		void string(const char* str) {
+			string(str, strlen(str));
+		}
+
+		void string(const char* str, size_t length) {
+			beginValue();
+			writeString(str, length);
+		}
+
+		// Writes everything up to the first container that is still open, with the headers of closed containers.
+		void flush() {
+			size_t end = openContainers.empty() ? buffer.size() : containers[openContainers.front()].position;
+			size_t closedCount = openContainers.empty() ? containers.size() : openContainers.front();
+			size_t written = 0;
+
+			for (size_t i = 0; i < closedCount; i++) {
+				auto& container = containers[i];
+				char header[5];
+				size_t headerSize = container.isMap
+					? writeHeader(header, container.count, 0x80, 15, 0, 0xDE, 0xDF)
+					: writeHeader(header, container.count, 0x90, 15, 0, 0xDC, 0xDD);
+
+				stream.write(buffer.data() + written, container.position - written);
+				stream.write(header, headerSize);
+				written = container.position;
+			}
+
+			stream.write(buffer.data() + written, end - written);
+
+			buffer.erase(buffer.begin(), buffer.begin() + end);
+			containers.erase(containers.begin(), containers.begin() + closedCount);
+
+			for (auto& container : containers)
+				container.position -= end;
+			for (auto& index : openContainers)
+				index -= closedCount;
+		}
+	};
+}
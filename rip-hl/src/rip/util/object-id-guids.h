@@ -1,32 +1,84 @@
 #pragma once
 #include <ucsl/object-id.h>
 #include <string>
-#include <cinttypes>
+#include <cstdint>
+#include <cstring>
 
 namespace rip::util {
+	namespace internal {
+		// Order in which the bytes of an ObjectIdV2 appear in its GUID string, and where each byte's digits are.
+		inline constexpr uint8_t guidByteOrder[16]{ 3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 };
+		inline constexpr uint8_t guidDigitPositions[16]{ 1, 3, 5, 7, 10, 12, 15, 17, 20, 22, 25, 27, 29, 31, 33, 35 };
+		inline constexpr char guidTemplate[39]{ "{00000000-0000-0000-0000-000000000000}" };
+		inline constexpr char hexDigits[16]{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+
+		struct HexDecodeTable {
+			int8_t values[256]{};
+
+			constexpr HexDecodeTable() {
+				for (int i = 0; i < 256; i++)
+					values[i] = -1;
+				for (int i = 0; i < 10; i++)
+					values['0' + i] = static_cast<int8_t>(i);
+				for (int i = 0; i < 6; i++) {
+					values['a' + i] = static_cast<int8_t>(10 + i);
+					values['A' + i] = static_cast<int8_t>(10 + i);
+				}
+			}
+		};
+
+		inline constexpr HexDecodeTable hexDecodeTable{};
+
+		// Formats the first `count` bytes (in GUID order) of `bytes`, leaving the remaining digits zero.
+		inline void writeGUID(const uint8_t* bytes, size_t count, char* guid) {
+			memcpy(guid, guidTemplate, sizeof(guidTemplate));
+
+			for (size_t i = 0; i < count; i++) {
+				uint8_t byte = bytes[guidByteOrder[i]];
+
+				guid[guidDigitPositions[i]] = hexDigits[byte >> 4];
+				guid[guidDigitPositions[i] + 1] = hexDigits[byte & 0xF];
+			}
+		}
+
+		// Parses the first `count` bytes (in GUID order) of a GUID string. The remaining bytes only need to be valid hex.
+		inline bool readGUID(uint8_t* bytes, size_t count, const char* str) {
+			if (str == nullptr)
+				return false;
+
+			// Validated character by character, so a shorter string fails at its terminator. As with the old
+			// sscanf based parser, the closing brace is not required.
+			for (size_t i = 0; i < 37; i++) {
+				if (guidTemplate[i] == '0' ? hexDecodeTable.values[static_cast<uint8_t>(str[i])] < 0 : str[i] != guidTemplate[i])
+					return false;
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				const char* digits = str + guidDigitPositions[i];
+
+				bytes[guidByteOrder[i]] = static_cast<uint8_t>((hexDecodeTable.values[static_cast<uint8_t>(digits[0])] << 4) | hexDecodeTable.values[static_cast<uint8_t>(digits[1])]);
+			}
+
+			return true;
+		}
+	}
+
 	inline bool fromGUID(ucsl::objectids::ObjectIdV1& id, const char* str) {
-		auto& b = reinterpret_cast<uint8_t(&)[4]>(id);
-		uint8_t i[12];
-		int res = sscanf_s(str, "{%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "}", &b[3], &b[2], &b[1], &b[0], &i[0], &i[1], &i[2], &i[3], &i[4], &i[5], &i[6], &i[7], &i[8], &i[9], &i[10], &i[11]);
-		return res == 16;
+		return internal::readGUID(reinterpret_cast<uint8_t*>(&id), 4, str);
 	}
 
 	inline bool fromGUID(ucsl::objectids::ObjectIdV2& id, const char* str) {
-		auto& b = reinterpret_cast<uint8_t(&)[16]>(id);
-		int res = sscanf_s(str, "{%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "}", &b[3], &b[2], &b[1], &b[0], &b[5], &b[4], &b[7], &b[6], &b[8], &b[9], &b[10], &b[11], &b[12], &b[13], &b[14], &b[15]);
-		return res == 16;
+		return internal::readGUID(reinterpret_cast<uint8_t*>(&id), 16, str);
 	}
 
 	template<size_t Len, typename = std::enable_if_t<Len >= 39>>
 	inline void toGUID(const ucsl::objectids::ObjectIdV1& id, char (&guid)[Len]) {
-		auto& b = reinterpret_cast<const uint8_t(&)[4]>(id);
-		sprintf_s(guid, "{%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "}", b[3], b[2], b[1], b[0], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+		internal::writeGUID(reinterpret_cast<const uint8_t*>(&id), 4, guid);
 	}
 
 	template<size_t Len, typename = std::enable_if_t<Len >= 39>>
 	inline void toGUID(const ucsl::objectids::ObjectIdV2& id, char(&guid)[Len]) {
-		auto& b = reinterpret_cast<const uint8_t(&)[16]>(id);
-		sprintf_s(guid, "{%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "-%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "%02" SCNx8 "}", b[3], b[2], b[1], b[0], b[5], b[4], b[7], b[6], b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+		internal::writeGUID(reinterpret_cast<const uint8_t*>(&id), 16, guid);
 	}
 
 	template<typename T>
@@ -0,0 +1,65 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rip::util {
+	inline unsigned int get_worker_count() {
+		unsigned int count = std::thread::hardware_concurrency();
+		return count == 0 ? 1 : count;
+	}
+
+	/*
+	 * Calls f(i) for every i in [0, count), spread over up to workerCount threads, and waits for all of them.
+	 * Work is handed out one index at a time, so indices should be reasonably large units of work.
+	 * If any call throws, the remaining indices are skipped and the first exception is rethrown.
+	 */
+	template<typename F>
+	void parallel_for(size_t count, F&& f, unsigned int workerCount = get_worker_count()) {
+		size_t threadCount = std::min(static_cast<size_t>(workerCount), count);
+
+		if (threadCount <= 1) {
+			for (size_t i = 0; i < count; i++)
+				f(i);
+			return;
+		}
+
+		std::atomic<size_t> next{};
+		std::exception_ptr exception{};
+		std::mutex exceptionMutex{};
+
+		auto worker = [&]() {
+			size_t i;
+
+			while ((i = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+				try {
+					f(i);
+				}
+				catch (...) {
+					std::lock_guard lock{ exceptionMutex };
+
+					if (!exception)
+						exception = std::current_exception();
+
+					next.store(count, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		{
+			std::vector<std::jthread> threads{};
+			threads.reserve(threadCount - 1);
+
+			for (size_t i = 1; i < threadCount; i++)
+				threads.emplace_back(worker);
+
+			worker();
+		}
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+}
@@ -44,7 +44,7 @@ ResourceType Config::getResourceType() const {
 		return resourceType.value();
 
 	std::string inputExt = inputFile.extension().generic_string();
-	if ((inputExt == ".json" || inputExt == ".hson"))
+	if ((inputExt == ".json" || inputExt == ".hson" || inputExt == ".msgpack"))
 		if (auto resType = getResourceTypeByExtension(inputFile.stem()))
 			return resType.value();
 
@@ -68,6 +68,9 @@ Format Config::getInputFormat() const {
 	if (inputFile.extension() == ".hson")
 		return Format::HSON;
 
+	if (inputFile.extension() == ".msgpack")
+		return Format::MSGPACK;
+
 	if (getResourceTypeByExtension(inputFile) == getResourceType())
 		return Format::BINARY;
 
@@ -93,6 +96,9 @@ Format Config::getOutputFormat() const {
 	if (outputFile.extension() == ".hson")
 		return Format::HSON;
 
+	if (outputFile.extension() == ".msgpack")
+		return Format::MSGPACK;
+
 	if (outputFile.extension().generic_string() == extByResourceType[getResourceType()])
 		return Format::BINARY;
 
@@ -105,12 +111,13 @@ std::filesystem::path Config::getOutputFile() const {
 
 	std::filesystem::path replacedFile{ inputFile };
 
-	if ((replacedFile.extension() == ".json" || replacedFile.extension() == ".hson") && replacedFile.stem().has_extension() && resourceTypeByExt.contains(replacedFile.stem().extension().generic_string()))
+	if ((replacedFile.extension() == ".json" || replacedFile.extension() == ".hson" || replacedFile.extension() == ".msgpack") && replacedFile.stem().has_extension() && resourceTypeByExt.contains(replacedFile.stem().extension().generic_string()))
 		replacedFile.replace_extension();
 
 	switch (getOutputFormat()) {
 	case Format::JSON: return std::move(replacedFile.replace_extension(extByResourceType[getResourceType()] + ".json"));
 	case Format::HSON: return std::move(replacedFile.replace_extension(extByResourceType[getResourceType()] + ".hson"));
+	case Format::MSGPACK: return std::move(replacedFile.replace_extension(extByResourceType[getResourceType()] + ".msgpack"));
 	case Format::BINARY: return std::move(replacedFile.replace_extension(extByResourceType[getResourceType()]));
 	}
 
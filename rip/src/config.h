@@ -9,6 +9,7 @@ enum class Format {
 	BINARY,
 	JSON,
 	HSON,
+	MSGPACK,
 };
 
 enum class ResourceType {
@@ -45,6 +46,10 @@ struct Config {
 	std::filesystem::path schema{};
 	std::filesystem::path hedgesetTemplate{};
 	AddressingMode addressingMode{ AddressingMode::_64 };
+	bool loadInPlace{};
+	unsigned int jobs{ 1 };
+	bool deduplicate{};
+	bool fullSchema{};
 	static std::string rflClass;
 
 	ResourceType getResourceType() const;
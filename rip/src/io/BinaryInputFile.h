@@ -2,27 +2,18 @@
 #include <rip/binary/containers/binary-file/v1.h>
 #include <rip/binary/containers/binary-file/v2.h>
 #include <config.h>
+#include <rip/util/mapped-file.h>
 #include "InputFile.h"
-#include "mem_stream.h"
-#include <fstream>
 
 template<typename T, typename AddrType>
 class BinaryInputFileV1 : public InputFile<T> {
-	std::unique_ptr<uint8_t[]> fileData;
 	T* data{};
 
 public:
 	BinaryInputFileV1(const Config& config) {
-		std::ifstream ifs{ config.inputFile, std::ios::binary | std::ios::ate };
-		size_t fileSize = ifs.tellg();
-		
-		fileData = std::make_unique<uint8_t[]>(fileSize);
-		
-		ifs.seekg(std::ios::beg);
-		ifs.read((char*)&fileData[0], fileSize);
+		rip::util::mapped_file file{ config.inputFile };
 
-        imemstream ims{ (char*)&fileData[0], fileSize };
-        rip::binary::containers::binary_file::v1::BinaryFileDeserializer<AddrType> deserializer{ ims };
+        rip::binary::containers::binary_file::v1::BinaryFileDeserializer<AddrType> deserializer{ file.data(), file.size() };
 
 		//std::ifstream ifs{ config.inputFile, std::ios::binary };
 		//rip::binary::containers::binary_file::v1::BinaryFileDeserializer<size_t> deserializer{ ifs };
@@ -41,21 +32,39 @@ public:
 
 template<typename T, typename AddrType>
 class BinaryInputFileV2 : public InputFile<T> {
-    std::unique_ptr<uint8_t[]> fileData;
+    rip::util::mapped_file inPlaceFile{};
     T* data{};
 
+    // The file's layout is the same as the in-memory layout, so the resolver can hand out pointers into the mapping directly.
+    // The resolver patches the mapping through the file's own offset tables, so anything that doesn't pass validation is
+    // left to the bounds checked deserializer instead.
+    static bool canLoadInPlace(const rip::util::mapped_file& file) {
+        if constexpr (sizeof(AddrType) != 8 || std::endian::native != std::endian::little)
+            return false;
+        else {
+            if (file.size() < sizeof(rip::binary::containers::binary_file::v2::FileHeader))
+                return false;
+
+            auto* header = static_cast<const rip::binary::containers::binary_file::v2::FileHeader*>(file.data());
+
+            return header->magic == "BINA" && header->version == "210" && header->endianness == 'L' && header->chunkCount > 0
+                && rip::binary::containers::binary_file::v2::BinaryFileResolver::validate(file.data(), file.size());
+        }
+    }
+
 public:
     BinaryInputFileV2(const Config& config) {
-        std::ifstream ifs{ config.inputFile, std::ios::binary | std::ios::ate };
-        size_t fileSize = ifs.tellg();
+        rip::util::mapped_file file{ config.inputFile };
 
-        fileData = std::make_unique<uint8_t[]>(fileSize);
+        if (config.loadInPlace && canLoadInPlace(file)) {
+            rip::binary::containers::binary_file::v2::BinaryFileResolver resolver{ file.data() };
 
-        ifs.seekg(std::ios::beg);
-        ifs.read((char*)&fileData[0], fileSize);
+            data = static_cast<T*>(resolver.getData(0));
+            inPlaceFile = std::move(file);
+            return;
+        }
 
-        imemstream ims{ (char*)&fileData[0], fileSize };
-        rip::binary::containers::binary_file::v2::BinaryFileDeserializer<AddrType> deserializer{ ims };
+        rip::binary::containers::binary_file::v2::BinaryFileDeserializer<AddrType> deserializer{ file.data(), file.size() };
 
         //std::ifstream ifs{ config.inputFile, std::ios::binary };
         //rip::binary::containers::binary_file::v2::BinaryFileDeserializer<size_t> deserializer{ ifs };
@@ -64,7 +73,8 @@ public:
     }
 
     virtual ~BinaryInputFileV2() {
-        GI::AllocatorSystem::get_allocator()->Free(data);
+        if (!inPlaceFile.data())
+            GI::AllocatorSystem::get_allocator()->Free(data);
     }
 
     virtual T* getData() override {
@@ -0,0 +1,20 @@
+#pragma once
+#include <rip/hson/HsonDeserializer.h>
+#include <config.h>
+#include "InputFile.h"
+
+template<typename T>
+class HsonInputFile : public InputFile<T> {
+	std::string inputFile;
+	rip::hson::HsonDeserializer<GI, T> deserializer;
+	T* data{};
+
+public:
+	HsonInputFile(const Config& config) : inputFile{ config.inputFile.generic_string() }, deserializer{ inputFile.c_str() } {
+		data = deserializer.deserialize();
+	}
+
+	virtual T* getData() override {
+		return data;
+	}
+};
@@ -4,27 +4,18 @@
 #include <rip/binary/containers/mirage/v2.h>
 #include <rip/binary/serialization/ReflectionDeserializer.h>
 #include <config.h>
+#include <rip/util/mapped-file.h>
 #include "InputFile.h"
-#include "mem_stream.h"
-#include <fstream>
 
 template<typename T, typename AddrType>
 class MirageInputFileV1 : public InputFile<T> {
-    std::unique_ptr<uint8_t[]> fileData;
     T* data{};
 
 public:
     MirageInputFileV1(const Config& config) {
-        std::ifstream ifs{ config.inputFile, std::ios::binary | std::ios::ate };
-        size_t fileSize = ifs.tellg();
+        rip::util::mapped_file file{ config.inputFile };
 
-        fileData = std::make_unique<uint8_t[]>(fileSize);
-
-        ifs.seekg(std::ios::beg);
-        ifs.read((char*)&fileData[0], fileSize);
-
-        imemstream ims{ (char*)&fileData[0], fileSize };
-        rip::binary::containers::mirage::v1::MirageResourceImageReader<AddrType> reader{ ims };
+        rip::binary::containers::mirage::v1::MirageResourceImageReader<AddrType> reader{ file.data(), file.size() };
 
         auto stream = reader.get_data();
 
@@ -43,21 +34,13 @@ public:
 
 template<typename T, typename AddrType>
 class MirageInputFileV2 : public InputFile<T> {
-    std::unique_ptr<uint8_t[]> fileData;
     T* data{};
 
 public:
     MirageInputFileV2(const Config& config) {
-        std::ifstream ifs{ config.inputFile, std::ios::binary | std::ios::ate };
-        size_t fileSize = ifs.tellg();
-
-        fileData = std::make_unique<uint8_t[]>(fileSize);
-
-        ifs.seekg(std::ios::beg);
-        ifs.read((char*)&fileData[0], fileSize);
+        rip::util::mapped_file file{ config.inputFile };
 
-        imemstream ims{ (char*)&fileData[0], fileSize };
-        rip::binary::containers::mirage::v2::MirageResourceImageReader<AddrType> reader{ ims };
+        rip::binary::containers::mirage::v2::MirageResourceImageReader<AddrType> reader{ file.data(), file.size() };
 
         auto root_node = reader.get_root_node();
 
@@ -0,0 +1,24 @@
+#pragma once
+#include <ucsl-reflection/providers/simplerfl.h>
+#include <rip/binary/serialization/MsgPackDeserializer.h>
+#include <config.h>
+#include "InputFile.h"
+
+template<typename T>
+class MsgPackInputFile : public InputFile<T> {
+	T* data{};
+
+public:
+	MsgPackInputFile(const Config& config) {
+		std::string inputFile = config.inputFile.generic_string();
+		data = rip::binary::MsgPackDeserializer<GI>{ inputFile.c_str() }.deserialize<T>(ucsl::reflection::providers::simplerfl<GI>::template reflect<T>());
+	}
+
+	virtual ~MsgPackInputFile() {
+		GI::AllocatorSystem::get_allocator()->Free(data);
+	}
+
+	virtual T* getData() override {
+		return data;
+	}
+};
@@ -1,10 +1,74 @@
 #pragma once
 #include <ucsl/rfl/rflclass.h>
 #include <rip/schemas/hedgeset.h>
+#include <rip/schemas/hedgeset-compiled.h>
+#include <rip/util/mapped-file.h>
 #include <config.h>
+#include <iostream>
+#include <string_view>
+#include <unordered_set>
 
+// Every run of printable characters in the input file, and the same run without its first character to cover
+// length prefixes that happen to be printable. Type names are stored as plain strings in all input formats, so
+// this finds every object, component and class name the file can refer to without having to parse it.
+std::unordered_set<std::string_view> scanInputNames(const rip::util::mapped_file& file) {
+	std::unordered_set<std::string_view> names{};
+	auto* data = static_cast<const char*>(file.data());
+	size_t start{};
+
+	for (size_t i = 0; i <= file.size(); i++) {
+		if (i < file.size() && data[i] > ' ' && data[i] < 0x7F && data[i] != '"' && data[i] != '\\')
+			continue;
+
+		if (i - start > 1) {
+			names.emplace(data + start, i - start);
+			names.emplace(data + start + 1, i - start - 1);
+		}
+
+		start = i + 1;
+	}
+
+	return names;
+}
+
+void loadCompiledHedgesetTemplate(const Config& config, const rip::schemas::hedgeset::compiled_schema_reader& cache) {
+	if (config.fullSchema) {
+		GI::reflectionDB->load_schema(cache.get_schema());
+		return;
+	}
+
+	rip::util::mapped_file inputFile{ config.inputFile };
+	auto inputNames = scanInputNames(inputFile);
+
+	GI::reflectionDB->load_schema(cache.get_schema([&inputNames](const char* name) { return inputNames.contains(name) || Config::rflClass == name; }));
+}
+
+// The compiled schema is cached next to the template and rebuilt whenever the template changes.
 void loadHedgesetTemplate(const Config& config) {
+	auto cacheFile = config.hedgesetTemplate;
+	cacheFile += ".ripcache";
+
+	uint64_t templateHash = rip::schemas::hedgeset::hash_template(config.hedgesetTemplate);
+	rip::schemas::hedgeset::compiled_schema_reader cache{};
+
+	if (cache.open(cacheFile, templateHash)) {
+		loadCompiledHedgesetTemplate(config, cache);
+		return;
+	}
+
 	auto templ = rip::schemas::hedgeset::load(config.hedgesetTemplate.generic_string());
 	rip::schemas::hedgeset::schema_builder s{ templ };
-	GI::reflectionDB->load_schema(s.get_schema());
+
+	try {
+		rip::schemas::hedgeset::compiled_schema_writer{ templ, s.get_schema(), templateHash }.write(cacheFile);
+	}
+	catch (std::runtime_error& e) {
+		std::cerr << "Could not write HedgeSet template cache: " << e.what() << std::endl;
+	}
+
+	// Go through the cache that was just written, so the first run loads the same classes as later ones.
+	if (cache.open(cacheFile, templateHash))
+		loadCompiledHedgesetTemplate(config, cache);
+	else
+		GI::reflectionDB->load_schema(s.get_schema());
 }
@@ -5,6 +5,8 @@
 #include <ucsl/resources/path/v1.h>
 #include <ucsl/resources/sobj/v1.h>
 #include <ucsl/resources/nxs/v1.h>
+#include <ucsl/resources/object-world/v2.h>
+#include <ucsl/resources/object-world/v3.h>
 #include <ucsl/resources/swif/v5.h>
 #include <ucsl/resources/swif/v6.h>
 #include <config.h>
@@ -12,6 +14,8 @@
 #include "MirageInputFile.h"
 #include "SWIFInputFile.h"
 #include "JsonInputFile.h"
+#include "MsgPackInputFile.h"
+#include "HsonInputFile.h"
 
 template<typename T>
 InputFile<T>* loadInputFile(const Config& config) {
@@ -36,6 +40,12 @@ InputFile<T>* loadInputFile(const Config& config) {
 		else
 			return new BinaryInputFileV2<T, size_t>{ config };
 	case Format::JSON: return new JsonInputFile<T>{ config };
+	case Format::MSGPACK: return new MsgPackInputFile<T>{ config };
+	case Format::HSON:
+		if constexpr (std::is_same_v<T, ucsl::resources::object_world::v2::ObjectWorldData<GI::AllocatorSystem>> || std::is_same_v<T, ucsl::resources::object_world::v3::ObjectWorldData<GI::AllocatorSystem>> || std::is_same_v<T, ucsl::resources::sobj::v1::SetObjectData<GI::AllocatorSystem>>)
+			return new HsonInputFile<T>{ config };
+		else
+			throw std::runtime_error{ "Invalid resource for HSON input. Use one of GEDIT,SOBJ." };
 	default: assert("unknown input format"); return nullptr;
 	}
 }
@@ -8,7 +8,8 @@
 #include <rip/binary/containers/binary-file/v2.h>
 #include <rip/binary/containers/mirage/v2.h>
 #include <rip/binary/containers/swif/SWIF.h>
-#include <rip/binary/serialization/JsonSerializer.h>
+#include <rip/binary/serialization/JsonStreamSerializer.h>
+#include <rip/binary/serialization/MsgPackSerializer.h>
 #include <rip/binary/serialization/ReflectionSerializer.h>
 #include <rip/hson/HsonSerializer.h>
 #include <config.h>
@@ -21,17 +22,17 @@ void writeOutputFileHSON(const Config& config, T* data) {
 
 template<typename AllocatorSystem>
 void writeOutputFileHSON(const Config& config, ucsl::resources::object_world::v2::ObjectWorldData<AllocatorSystem>* data) {
-	rip::hson::serialize<GI>(config.getOutputFile().generic_string(), *data);
+	rip::hson::serialize<GI>(config.getOutputFile().generic_string(), *data, config.jobs);
 }
 
 template<typename AllocatorSystem>
 void writeOutputFileHSON(const Config& config, ucsl::resources::object_world::v3::ObjectWorldData<AllocatorSystem>* data) {
-	rip::hson::serialize<GI>(config.getOutputFile().generic_string(), *data);
+	rip::hson::serialize<GI>(config.getOutputFile().generic_string(), *data, config.jobs);
 }
 
 template<typename AllocatorSystem>
 void writeOutputFileHSON(const Config& config, ucsl::resources::sobj::v1::SetObjectData<AllocatorSystem>* data) {
-	rip::hson::serialize<GI>(config.getOutputFile().generic_string(), *data);
+	rip::hson::serialize<GI>(config.getOutputFile().generic_string(), *data, config.jobs);
 }
 
 template<typename T>
@@ -39,49 +40,59 @@ void writeOutputFileOther(const Config& config, T* data) {
 	switch (config.getOutputFormat()) {
 	case Format::BINARY: {
 		std::ofstream ofs{ config.getOutputFile(), std::ios::binary };
+		rip::binary::SerializerOptions serializerOptions{ config.jobs, config.deduplicate };
 
 		if constexpr (std::is_same_v<T, ucsl::resources::swif::v5::SRS_PROJECT> || std::is_same_v<T, ucsl::resources::swif::v6::SRS_PROJECT>) {
-			rip::binary::containers::swif::v1::SWIFSerializer serializer{ ofs };
+			rip::binary::containers::swif::v1::SWIFSerializer serializer{ ofs, serializerOptions };
 			serializer.serialize<GI>(*data);
 		}
 		else if constexpr (std::is_same_v<T, ucsl::resources::material::contexts::ContextsData>) {
 			if (config.version == "1") {
 				rip::binary::containers::mirage::v1::MirageResourceImageWriter<size_t> writer{ ofs };
 				auto stream = writer.add_data(3);
-				rip::binary::ReflectionSerializer serializer{ stream };
+				rip::binary::ReflectionSerializer serializer{ stream, serializerOptions };
 				serializer.serialize<T>(*data, ucsl::reflection::providers::simplerfl<GI>::template reflect<T>());
 			}
 			else {
 				rip::binary::containers::mirage::v2::MirageResourceImageWriter<size_t> writer{ ofs };
 				auto root = writer.add_root_node("Material", 1);
 				auto contexts = root.add_last_leaf_node("Contexts", 3);
-				rip::binary::ReflectionSerializer serializer{ contexts };
+				rip::binary::ReflectionSerializer serializer{ contexts, serializerOptions };
 				serializer.serialize<T>(*data, ucsl::reflection::providers::simplerfl<GI>::template reflect<T>());
 			}
 		}
 		else {
-			rip::binary::containers::binary_file::v2::BinaryFileSerializer<size_t> serializer{ ofs };
+			rip::binary::containers::binary_file::v2::BinaryFileSerializer<size_t> serializer{ ofs, serializerOptions };
 			serializer.serialize<GI>(*data);
 		}
 		break;
 	}
 	case Format::JSON: {
-		yyjson_mut_doc* doc = yyjson_mut_doc_new(nullptr);
-
-		rip::binary::JsonSerializer serializer{ doc };
-		yyjson_mut_val* result = serializer.serialize(*data, ucsl::reflection::providers::simplerfl<GI>::template reflect<T>());
+		std::ofstream ofs{ config.getOutputFile(), std::ios::binary };
 
-		yyjson_mut_doc_set_root(doc, result);
+		{
+			rip::util::json_writer writer{ ofs, YYJSON_WRITE_PRETTY_TWO_SPACES | YYJSON_WRITE_ALLOW_INF_AND_NAN | YYJSON_WRITE_ALLOW_INVALID_UNICODE };
+			rip::binary::JsonStreamSerializer serializer{ writer };
+			serializer.serialize(*data, ucsl::reflection::providers::simplerfl<GI>::template reflect<T>());
+		}
 
-		yyjson_write_err err;
-		std::string filename = config.getOutputFile().generic_string();
-		yyjson_mut_write_file(filename.c_str(), doc, YYJSON_WRITE_PRETTY_TWO_SPACES | YYJSON_WRITE_ALLOW_INF_AND_NAN | YYJSON_WRITE_ALLOW_INVALID_UNICODE, nullptr, &err);
+		if (!ofs) {
+			std::cerr << "Error writing json: file write error" << std::endl;
+		}
+		break;
+	}
+	case Format::MSGPACK: {
+		std::ofstream ofs{ config.getOutputFile(), std::ios::binary };
 
-		if (err.code != YYJSON_WRITE_SUCCESS) {
-			std::cerr << "Error writing json: " << err.msg << std::endl;
+		{
+			rip::util::msgpack_writer writer{ ofs };
+			rip::binary::MsgPackSerializer serializer{ writer };
+			serializer.serialize(*data, ucsl::reflection::providers::simplerfl<GI>::template reflect<T>());
 		}
 
-		yyjson_mut_doc_free(doc);
+		if (!ofs) {
+			std::cerr << "Error writing msgpack: file write error" << std::endl;
+		}
 		break;
 	}
 	}
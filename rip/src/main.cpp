@@ -13,6 +13,7 @@ std::map<std::string, Format> formatMap{
 	{ "binary", Format::BINARY },
 	{ "json", Format::JSON },
 	{ "hson", Format::HSON },
+	{ "msgpack", Format::MSGPACK },
 };
 
 std::map<std::string, ResourceType> resourceTypeMap{
@@ -63,6 +64,10 @@ int main(int argc, char** argv) {
 	app.add_option("-t,--hedgeset-template", config.hedgesetTemplate, "The HedgeSet template file to use.")
 		->excludes(schemaOpt);
 	app.add_option("-c,--rfl-class", Config::rflClass, "When converting RFL files: the name of the RflClass to use.");
+	app.add_flag("--in-place", config.loadInPlace, "Resolve little endian 64-bit BINA input files in place instead of copying their data. Other input files are loaded normally.");
+	app.add_option("-j,--jobs", config.jobs, "The number of threads to use when writing binary or HSON output. 0 uses all cores.");
+	app.add_flag("--deduplicate", config.deduplicate, "Write identical blocks without outgoing pointers only once in binary output.");
+	app.add_flag("--full-schema", config.fullSchema, "Load every class in the HedgeSet template instead of only the ones the input file refers to.");
 	app.validate_positionals();
 
 	CLI11_PARSE(app, argc, argv);
@@ -74,9 +79,6 @@ int main(int argc, char** argv) {
 		std::cerr << "Input file: " << config.inputFile.generic_string() << std::endl;
 		std::cerr << "Output file: " << config.getOutputFile().generic_string() << std::endl;
 
-		if (config.getInputFormat() == Format::HSON)
-			throw new std::runtime_error{ "HSON input currently not yet supported." };
-
 		ucsl::reflection::game_interfaces::standalone::StandaloneGameInterface::boot();
 
 		if (!config.hedgesetTemplate.empty())